@@ -6,52 +6,204 @@
 #include "Misc/FileHelper.h"
 #include "JsonObjectConverter.h"
 #include "Misc/PackageName.h"
+#include "Misc/CoreDelegates.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/ParallelFor.h"
+#include "Interfaces/IPluginManager.h"
 
 DEFINE_LOG_CATEGORY_STATIC(BlueprintSourceMapSub, Log, All)
 
 /**
- * Helper class to build a file map for us when updating header references. 
+ * Helper class to find the source files a controller could be in when updating header references.
+ * Each directory directly under a Source directory (normally a module) is searched in parallel.
  */
-class FFileMapBuilder : public IPlatformFile::FDirectoryVisitor {
+class FSourceFileFinder {
 public:
-    // A map of file name (with extension) to full file path.
-    TMap<FString, FString> FileMap;
-
-    virtual bool Visit(const TCHAR* filenameOrDirectory, bool isDirectory) override {
-        if (!isDirectory) {
-            FString name = FPaths::GetCleanFilename(filenameOrDirectory);
-            if (!FileMap.Contains(name)) {
-                FileMap.Add(name, filenameOrDirectory);
-            } else {
-                UE_LOG(BlueprintSourceMapSub, Warning, TEXT("Duplicate filename when building file map: %s at %s"), *name, filenameOrDirectory);
+    FSourceFileFinder(const TArray<FString>& excludedDirectories, const TArray<FString>& extensions)
+        : _excludedDirectories(excludedDirectories), _extensions(extensions) { }
+
+    // File name (with extension) to the full path of every file with that name
+    TMultiMap<FString, FString> FileMap;
+
+    void Search(const TArray<FString>& sourceDirectories) {
+        IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+        TArray<FString> moduleDirectories;
+        TArray<FString> rootFiles;
+        for (const FString& sourceDirectory : sourceDirectories) {
+            platformFile.IterateDirectory(*sourceDirectory, [this, &moduleDirectories, &rootFiles] (const TCHAR* filenameOrDirectory, bool isDirectory) {
+                if (isDirectory) {
+                    if (!IsExcluded(filenameOrDirectory)) {
+                        moduleDirectories.Add(filenameOrDirectory);
+                    }
+                } else if (IsSourceFile(filenameOrDirectory)) {
+                    rootFiles.Add(filenameOrDirectory);
+                }
+                return true; // keep going
+            });
+        }
+
+        TArray<TArray<FString>> moduleFiles;
+        moduleFiles.SetNum(moduleDirectories.Num());
+        ParallelFor(moduleDirectories.Num(), [this, &moduleDirectories, &moduleFiles] (int32 index) {
+            SearchDirectory(moduleDirectories[index], moduleFiles[index]);
+        });
+
+        moduleFiles.Add(MoveTemp(rootFiles));
+        for (const TArray<FString>& files : moduleFiles) {
+            for (const FString& file : files) {
+                FileMap.Add(FPaths::GetCleanFilename(file), file);
+            }
+        }
+    }
+
+    /**
+     * Finds the file with the given name. If more than one has that name, they're all
+     * reported and the first one alphabetically is used.
+     */
+    bool FindFile(const FString& fileName, FString& outPath) const {
+        TArray<FString> paths;
+        FileMap.MultiFind(fileName, paths);
+        if (paths.Num() == 0) {
+            return false;
+        }
+
+        if (paths.Num() > 1) {
+            paths.Sort();
+            UE_LOG(BlueprintSourceMapSub, Warning, TEXT("UpdateMappings: Found %d files named %s. Using %s. The others are:"), paths.Num(), *fileName, *paths[0]);
+            for (int32 i = 1; i < paths.Num(); i++) {
+                UE_LOG(BlueprintSourceMapSub, Warning, TEXT("    %s"), *paths[i]);
+            }
+        }
+
+        outPath = paths[0];
+        return true;
+    }
+
+private:
+    void SearchDirectory(const FString& directory, TArray<FString>& outFiles) const {
+        IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+        platformFile.IterateDirectory(*directory, [this, &outFiles] (const TCHAR* filenameOrDirectory, bool isDirectory) {
+            if (isDirectory) {
+                if (!IsExcluded(filenameOrDirectory)) {
+                    SearchDirectory(filenameOrDirectory, outFiles);
+                }
+            } else if (IsSourceFile(filenameOrDirectory)) {
+                outFiles.Add(filenameOrDirectory);
+            }
+            return true; // keep going
+        });
+    }
+
+    bool IsExcluded(const FString& directory) const {
+        FString directoryName = FPaths::GetCleanFilename(directory);
+        for (const FString& excludedDirectory : _excludedDirectories) {
+            if (directoryName.MatchesWildcard(excludedDirectory)) {
+                return true;
             }
         }
-        return true; // keep going
+        return false;
     }
+
+    bool IsSourceFile(const FString& file) const {
+        FString extension = FPaths::GetExtension(file, true);
+        return _extensions.Contains(extension);
+    }
+
+    const TArray<FString>& _excludedDirectories;
+    const TArray<FString>& _extensions;
 };
 
-void UBlueprintSourceMap::LoadMapping(FString projectSourceDir, FString sourceMapDir) {
+void UBlueprintSourceMap::LoadMapping(FString projectSourceDir, FString sourceMapDir, bool isSharded) {
     _projectRootDirectory = projectSourceDir;
     _sourceMapDir = sourceMapDir;
+    _isSharded = isSharded;
+
+    if (_isSharded) {
+        // Shards are loaded as they're needed
+        _sourceMap.BlueprintSourceMap.Empty();
+        _blueprintPathsBySourcePath.Empty();
+        _loadedShards.Empty();
+        _areAllShardsLoaded = false;
+        MigrateToShards();
+        return;
+    }
 
     FString expectedFilePath = GetFilePath();
 
+    // Remember which version of the file we have so we know when to reload it
     IFileManager& fileManager = IFileManager::Get();
+    _fileTimestamp = fileManager.GetTimeStamp(*expectedFilePath);
+
+    // If the file was deleted since we last loaded it, there are no mappings anymore
+    _sourceMap.BlueprintSourceMap.Empty();
     if (fileManager.FileExists(*expectedFilePath)) {
-        FString fileContents;
-        if (!FFileHelper::LoadFileToString(fileContents, *expectedFilePath)) {
-            // The file is there but we couldn't load it. That's strange.
-            UE_LOG(BlueprintSourceMapSub, Error, TEXT("Failed to load %s for automatic update support."), *expectedFilePath);
-            return;
+        LoadModelFromFile(expectedFilePath, _sourceMap);
+    }
+    RebuildSourceIndex();
+}
+
+void UBlueprintSourceMap::ReloadIfChanged() {
+    if (_isSharded) {
+        TArray<FString> changedShards;
+        for (const TPair<FString, FDateTime>& shard : _loadedShards) {
+            if (IFileManager::Get().GetTimeStamp(*GetShardFilePath(shard.Key)) != shard.Value) {
+                changedShards.Add(shard.Key);
+            }
         }
 
-        // Parse into JSON
-        _sourceMap.BlueprintSourceMap.Empty();
-        if (!FJsonObjectConverter::JsonObjectStringToUStruct(fileContents, &_sourceMap, 0, 0)) {
-            UE_LOG(BlueprintSourceMapSub, Error, TEXT("The blueprint source map was not deserialized from JSON properly. Could the file be corrupt?"));
-            return;
+        for (const FString& shardName : changedShards) {
+            UE_LOG(BlueprintSourceMapSub, Display, TEXT("%s changed on disk. Reloading it."), *GetShardFilePath(shardName));
+            LoadShard(shardName);
+        }
+
+        // Shards that were added since, like a content folder a teammate added, aren't loaded
+        // yet so look for them again if everything is supposed to be loaded
+        if (_areAllShardsLoaded && IFileManager::Get().GetTimeStamp(*GetShardDirectory()) != _shardDirectoryTimestamp) {
+            _areAllShardsLoaded = false;
+            LoadAllShards();
         }
+        return;
+    }
+
+    FDateTime timestamp = IFileManager::Get().GetTimeStamp(*GetFilePath());
+    if (timestamp == _fileTimestamp) {
+        return;
+    }
+
+    // Put anything we haven't saved yet back on top of what's on disk
+    TMap<FString, FBlueprintSourceModel> unsavedMappings;
+    for (const FString& blueprintPath : _dirtyBlueprintPaths) {
+        if (const FBlueprintSourceModel* model = _sourceMap.BlueprintSourceMap.Find(blueprintPath)) {
+            unsavedMappings.Add(blueprintPath, *model);
+        }
+    }
+
+    UE_LOG(BlueprintSourceMapSub, Display, TEXT("%s changed on disk. Reloading it."), *GetFilePath());
+    LoadMapping(_projectRootDirectory, _sourceMapDir, _isSharded);
+
+    for (const FString& blueprintPath : _dirtyBlueprintPaths) {
+        if (const FBlueprintSourceModel* model = unsavedMappings.Find(blueprintPath)) {
+            StoreMapping(blueprintPath, *model);
+        } else {
+            EraseMapping(blueprintPath);
+        }
+    }
+}
+
+void UBlueprintSourceMap::BeginDestroy() {
+    Flush();
+
+    if (_saveTickerHandle.IsValid()) {
+        FTSTicker::GetCoreTicker().RemoveTicker(_saveTickerHandle);
+        _saveTickerHandle.Reset();
     }
+    FCoreDelegates::OnEnginePreExit.Remove(_preExitHandle);
+    _preExitHandle.Reset();
+
+    Super::BeginDestroy();
 }
 
 void UBlueprintSourceMap::AddMapping(UBlueprint* blueprint, FString fullHeaderPath, FString fullCppPath) {
@@ -72,19 +224,23 @@ void UBlueprintSourceMap::AddMapping(UBlueprint* blueprint, FString fullHeaderPa
     model.CppPath = relativeCppPath;
 
     FString blueprintPath = blueprint->GetPathName();
+    EnsureShardLoaded(blueprintPath);
     if (_sourceMap.BlueprintSourceMap.Contains(blueprintPath)) {
-        _sourceMap.BlueprintSourceMap.Remove(blueprintPath);
         UE_LOG(BlueprintSourceMapSub, Warning, TEXT("Blueprint source map already included a mapping for %s"), *blueprintPath);
     }
-    _sourceMap.BlueprintSourceMap.Add(blueprintPath, model);
+    SetMapping(blueprintPath, model);
 }
 
 FBlueprintSourceModel UBlueprintSourceMap::GetSourcePathsFor(UBlueprint* blueprint, bool absolutePaths) {
+    return GetSourcePathsFor(blueprint->GetPathName(), absolutePaths);
+}
+
+FBlueprintSourceModel UBlueprintSourceMap::GetSourcePathsFor(const FString& blueprintPath, bool absolutePaths) {
     FBlueprintSourceModel result;
 
-    FString blueprintPath = blueprint->GetPathName();
-    if (_sourceMap.BlueprintSourceMap.Contains(blueprintPath)) {
-        result = _sourceMap.BlueprintSourceMap[blueprintPath];
+    EnsureShardLoaded(blueprintPath);
+    if (const FBlueprintSourceModel* model = _sourceMap.BlueprintSourceMap.Find(blueprintPath)) {
+        result = *model;
 
         if (absolutePaths) {
             result.HeaderPath = FPaths::Combine(_projectRootDirectory, result.HeaderPath);
@@ -97,43 +253,172 @@ FBlueprintSourceModel UBlueprintSourceMap::GetSourcePathsFor(UBlueprint* bluepri
     return result;
 }
 
-bool UBlueprintSourceMap::SaveMapping() {
-    FString jsonString = TEXT("");
-    if (FJsonObjectConverter::UStructToJsonObjectString(_sourceMap, jsonString)) {
-        FString filePath = GetFilePath();
+bool UBlueprintSourceMap::HasMapping(const FString& blueprintPath) {
+    EnsureShardLoaded(blueprintPath);
+    return _sourceMap.BlueprintSourceMap.Contains(blueprintPath);
+}
+
+TArray<FString> UBlueprintSourceMap::GetBlueprintPaths() {
+    // Every shard is needed to list them all
+    LoadAllShards();
+
+    TArray<FString> blueprintPaths;
+    _sourceMap.BlueprintSourceMap.GetKeys(blueprintPaths);
+    blueprintPaths.Sort();
+    return blueprintPaths;
+}
+
+FString UBlueprintSourceMap::GetBlueprintPathFor(const FString& sourcePath) {
+    // Any shard could have it
+    LoadAllShards();
 
-        // Make sure the directory exists and create it if it doesn't
-        FString directory = FPaths::GetPath(filePath);
-        if (!FPaths::DirectoryExists(directory)) {
-            IFileManager& fileManager = IFileManager::Get();
+    if (const FString* blueprintPath = _blueprintPathsBySourcePath.Find(NormalizeSourcePath(sourcePath))) {
+        return *blueprintPath;
+    }
+    return FString();
+}
 
-            if (!fileManager.MakeDirectory(*directory, true)) {
-                UE_LOG(BlueprintSourceMapSub, Error, TEXT("Failed to save blueprint source mappings to file. The directory did not exist and we could not create it: %s!"), *filePath);
+bool UBlueprintSourceMap::RenameBlueprint(const FString& oldBlueprintPath, const FString& newBlueprintPath) {
+    EnsureShardLoaded(oldBlueprintPath);
+    const FBlueprintSourceModel* model = _sourceMap.BlueprintSourceMap.Find(oldBlueprintPath);
+    if (model == nullptr) {
+        return false;
+    }
+
+    FBlueprintSourceModel movedModel = *model;
+    RemoveMapping(oldBlueprintPath);
+    SetMapping(newBlueprintPath, movedModel);
+    UE_LOG(BlueprintSourceMapSub, Display, TEXT("Moved the mapping for %s to %s"), *oldBlueprintPath, *newBlueprintPath);
+    return true;
+}
+
+bool UBlueprintSourceMap::RemoveBlueprint(const FString& blueprintPath) {
+    EnsureShardLoaded(blueprintPath);
+    const FBlueprintSourceModel* model = _sourceMap.BlueprintSourceMap.Find(blueprintPath);
+    if (model == nullptr) {
+        return false;
+    }
+
+    // Hold on to it for a little while in case the blueprint shows up somewhere else
+    PurgeRemovedBlueprints();
+    _removedBlueprints.RemoveAll([&blueprintPath] (const FRemovedBlueprintMapping& removed) { return removed.BlueprintPath.Equals(blueprintPath); });
+    _removedBlueprints.Add({ blueprintPath, *model, FPlatformTime::Seconds() });
+    RemoveMapping(blueprintPath);
+    return true;
+}
+
+bool UBlueprintSourceMap::RestoreBlueprint(const FString& blueprintPath) {
+    PurgeRemovedBlueprints();
+
+    // Only a blueprint with the same name can be the one that moved. If more than one
+    // was removed, there's no way to tell which one this is so leave them all alone.
+    FString blueprintName = FPackageName::ObjectPathToObjectName(blueprintPath);
+    int32 removedIndex = INDEX_NONE;
+    for (int32 index = 0; index < _removedBlueprints.Num(); index++) {
+        if (FPackageName::ObjectPathToObjectName(_removedBlueprints[index].BlueprintPath).Equals(blueprintName)) {
+            if (removedIndex != INDEX_NONE) {
+                UE_LOG(BlueprintSourceMapSub, Warning, TEXT("Several blueprints named %s were just removed so the mapping for %s can't be restored. Use Update Mappings to fix it."), *blueprintName, *blueprintPath);
                 return false;
             }
+            removedIndex = index;
         }
+    }
+    if (removedIndex == INDEX_NONE) {
+        return false;
+    }
 
-        if (!FFileHelper::SaveStringToFile(jsonString, *filePath)) {
-            UE_LOG(BlueprintSourceMapSub, Error, TEXT("Failed to save blueprint source mappings to file %s!"), *filePath);
-            return false;
-        }
-    } else {
-        UE_LOG(BlueprintSourceMapSub, Error, TEXT("Failed to convert blueprint source mappings to json!"));
+    EnsureShardLoaded(blueprintPath);
+    if (_sourceMap.BlueprintSourceMap.Contains(blueprintPath)) {
         return false;
     }
 
+    FRemovedBlueprintMapping removed = _removedBlueprints[removedIndex];
+    _removedBlueprints.RemoveAt(removedIndex);
+    SetMapping(blueprintPath, removed.Model);
+    UE_LOG(BlueprintSourceMapSub, Display, TEXT("Restored the mapping for %s from %s"), *blueprintPath, *removed.BlueprintPath);
     return true;
 }
 
-bool UBlueprintSourceMap::UpdateMappings(const TArray<UBlueprint*>& filesToUpdate, FString nameSuffix) {
-    // Build a filemap of the source directory
-    IFileManager& fileManager = IFileManager::Get();
-    FFileMapBuilder mapBuilder;
-    if (!fileManager.IterateDirectoryRecursively(*_projectRootDirectory, mapBuilder)) {
-        UE_LOG(BlueprintSourceMapSub, Error, TEXT("UpdateMappings: Could not iterate directory at %s"), *_projectRootDirectory);
+/**
+ * Forgets removed blueprints that weren't added back soon enough to have been moved.
+ */
+void UBlueprintSourceMap::PurgeRemovedBlueprints() {
+    double oldestRemovedTime = FPlatformTime::Seconds() - RemovedBlueprintLifetimeSeconds;
+    _removedBlueprints.RemoveAll([oldestRemovedTime] (const FRemovedBlueprintMapping& removed) { return removed.RemovedTime < oldestRemovedTime; });
+}
+
+bool UBlueprintSourceMap::MoveSourceFile(const FString& oldSourcePath, const FString& newSourcePath) {
+    FString blueprintPath = GetBlueprintPathFor(oldSourcePath);
+    const FBlueprintSourceModel* model = _sourceMap.BlueprintSourceMap.Find(blueprintPath);
+    if (model == nullptr) {
         return false;
     }
 
+    FString oldRelativePath = NormalizeSourcePath(oldSourcePath);
+    FString newRelativePath = NormalizeSourcePath(newSourcePath);
+    FBlueprintSourceModel movedModel = *model;
+    if (NormalizeSourcePath(movedModel.HeaderPath).Equals(oldRelativePath)) {
+        movedModel.HeaderPath = newRelativePath;
+    }
+    if (NormalizeSourcePath(movedModel.CppPath).Equals(oldRelativePath)) {
+        movedModel.CppPath = newRelativePath;
+    }
+
+    SetMapping(blueprintPath, movedModel);
+    UE_LOG(BlueprintSourceMapSub, Display, TEXT("Moved %s to %s in the mapping for %s"), *oldRelativePath, *newRelativePath, *blueprintPath);
+    return true;
+}
+
+bool UBlueprintSourceMap::SaveMapping() {
+    // Don't overwrite changes someone else made to the file
+    ReloadIfChanged();
+
+    bool isSaved = false;
+    if (_isSharded) {
+        isSaved = SaveShards();
+    } else {
+        FString filePath = GetFilePath();
+        isSaved = SaveModelToFile(_sourceMap, filePath);
+        if (isSaved) {
+            _fileTimestamp = IFileManager::Get().GetTimeStamp(*filePath);
+        }
+    }
+
+    // Everything is saved so there's nothing left for the pending save to do
+    if (isSaved) {
+        _dirtyBlueprintPaths.Empty();
+        if (_saveTickerHandle.IsValid()) {
+            FTSTicker::GetCoreTicker().RemoveTicker(_saveTickerHandle);
+            _saveTickerHandle.Reset();
+        }
+    }
+
+    return isSaved;
+}
+
+bool UBlueprintSourceMap::Flush() {
+    if (_dirtyBlueprintPaths.Num() == 0) {
+        return true;
+    }
+    return SaveMapping();
+}
+
+bool UBlueprintSourceMap::UpdateMappings(const TArray<UBlueprint*>& filesToUpdate, FString nameSuffix, const TArray<FString>& excludedDirectories, const TArray<FString>& extensions) {
+    // Every mapping is checked below so we need all of them
+    LoadAllShards();
+
+    // Build a filemap of the source directories
+    IFileManager& fileManager = IFileManager::Get();
+    double searchTimeBefore = FPlatformTime::Seconds();
+    TArray<FString> sourceDirectories = GetSourceDirectories();
+    FSourceFileFinder fileFinder(excludedDirectories, extensions);
+    fileFinder.Search(sourceDirectories);
+    double searchTimeMs = (FPlatformTime::Seconds() - searchTimeBefore) * 1000.0;
+    UE_LOG(BlueprintSourceMapSub, Display, TEXT("UpdateMappings: Found %d source files in %d source directories in %f ms"), fileFinder.FileMap.Num(), sourceDirectories.Num(), searchTimeMs);
+
+    // The found paths are absolute so make them relative to the absolute project directory
+    FString fullProjectRootDirectory = FPaths::ConvertRelativePathToFull(_projectRootDirectory);
+
     for (UBlueprint* blueprint : filesToUpdate) {
         // Get the class name
         FString name = blueprint->GetName();
@@ -151,8 +436,8 @@ bool UBlueprintSourceMap::UpdateMappings(const TArray<UBlueprint*>& filesToUpdat
         bool cppExists = false;
         bool headerExists = false;
         FBlueprintSourceModel newPaths;
-        if (_sourceMap.BlueprintSourceMap.Contains(pathName)) {
-            FBlueprintSourceModel sourcePaths = _sourceMap.BlueprintSourceMap[pathName];
+        if (const FBlueprintSourceModel* existingPaths = _sourceMap.BlueprintSourceMap.Find(pathName)) {
+            FBlueprintSourceModel sourcePaths = *existingPaths;
 
             FString fullHeaderPath = FPaths::Combine(_projectRootDirectory, sourcePaths.HeaderPath);
             if (fileManager.FileExists(*fullHeaderPath)) {
@@ -171,9 +456,9 @@ bool UBlueprintSourceMap::UpdateMappings(const TArray<UBlueprint*>& filesToUpdat
         // Note if one of them is still there, it will already be in newPaths.
         if (!headerExists || !cppExists) {
             if (!headerExists) {
-                if (mapBuilder.FileMap.Contains(expectedHeaderName)) {
-                    FString newHeaderPath = mapBuilder.FileMap[expectedHeaderName];
-                    if (!FPaths::MakePathRelativeTo(newHeaderPath, *_projectRootDirectory)) {
+                FString newHeaderPath;
+                if (fileFinder.FindFile(expectedHeaderName, newHeaderPath)) {
+                    if (!FPaths::MakePathRelativeTo(newHeaderPath, *fullProjectRootDirectory)) {
                         UE_LOG(BlueprintSourceMapSub, Error, TEXT("UpdateMappings: Could not find a relative path for header file %s"), *newHeaderPath);
                         continue;
                     }
@@ -182,9 +467,9 @@ bool UBlueprintSourceMap::UpdateMappings(const TArray<UBlueprint*>& filesToUpdat
             }
 
             if (!cppExists) {
-                if (mapBuilder.FileMap.Contains(expectedCppName)) {
-                    FString newCppPath = mapBuilder.FileMap[expectedCppName];
-                    if (!FPaths::MakePathRelativeTo(newCppPath, *_projectRootDirectory)) {
+                FString newCppPath;
+                if (fileFinder.FindFile(expectedCppName, newCppPath)) {
+                    if (!FPaths::MakePathRelativeTo(newCppPath, *fullProjectRootDirectory)) {
                         UE_LOG(BlueprintSourceMapSub, Error, TEXT("UpdateMappings: Could not find a relative path for cpp file %s"), *newCppPath);
                         continue;
                     }
@@ -193,23 +478,30 @@ bool UBlueprintSourceMap::UpdateMappings(const TArray<UBlueprint*>& filesToUpdat
             }
 
             // Add the updated entry, replacing the old one if needed
-            if (_sourceMap.BlueprintSourceMap.Contains(pathName))
-                _sourceMap.BlueprintSourceMap.Remove(pathName);
-            _sourceMap.BlueprintSourceMap.Add(pathName, newPaths);
+            SetMapping(pathName, newPaths);
         }
     }
 
     // Take this opportunity to check that all the blueprints in our mapping
     // still exist as well and remove them from the table if they do not.
+    double timeBefore = FPlatformTime::Seconds();
+    TArray<FString> blueprintPaths;
+    _sourceMap.BlueprintSourceMap.GetKeys(blueprintPaths);
+    TSet<FString> existingBlueprints = FindExistingBlueprints(blueprintPaths);
+
     TArray<FString> keysToRemove;
-    for (auto& entry : _sourceMap.BlueprintSourceMap) {
-        if (!DoesBlueprintExist(entry.Key)) {
-            keysToRemove.Add(entry.Key);
+    for (const FString& blueprintPath : blueprintPaths) {
+        if (!existingBlueprints.Contains(blueprintPath)) {
+            keysToRemove.Add(blueprintPath);
         }
     }
 
+    double elapsedTimeMs = (FPlatformTime::Seconds() - timeBefore) * 1000.0;
+    UE_LOG(BlueprintSourceMapSub, Display, TEXT("UpdateMappings: Checked %d mappings in %f ms. %d no longer exist."),
+        blueprintPaths.Num(), elapsedTimeMs, keysToRemove.Num());
+
     for (const FString& key : keysToRemove) {
-        _sourceMap.BlueprintSourceMap.Remove(key);
+        RemoveMapping(key);
     }
 
     // Save
@@ -221,10 +513,348 @@ FString UBlueprintSourceMap::GetFilePath() {
 }
 
 /**
- * Returns true if a blueprint with the given reference path exists and false if it does not.
- * @param blueprintPath The reference path to the blueprint (For example "/Game/SomeSubFolder/WBP_AnotherExample.WBP_AnotherExample")
+ * Returns the Source directories of the project and of the plugins in the project as absolute paths.
+ */
+TArray<FString> UBlueprintSourceMap::GetSourceDirectories() {
+    TArray<FString> sourceDirectories;
+    sourceDirectories.Add(FPaths::ConvertRelativePathToFull(FPaths::Combine(_projectRootDirectory, TEXT("Source"))));
+
+    for (const TSharedRef<IPlugin>& plugin : IPluginManager::Get().GetDiscoveredPlugins()) {
+        if (plugin->GetLoadedFrom() == EPluginLoadedFrom::Project) {
+            FString pluginSourceDirectory = FPaths::ConvertRelativePathToFull(FPaths::Combine(plugin->GetBaseDir(), TEXT("Source")));
+            if (FPaths::DirectoryExists(pluginSourceDirectory)) {
+                sourceDirectories.Add(pluginSourceDirectory);
+            }
+        }
+    }
+
+    return sourceDirectories;
+}
+
+TSet<FString> UBlueprintSourceMap::FindExistingBlueprints(const TArray<FString>& blueprintPaths) {
+    IAssetRegistry& assetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+
+    // If the editor is still discovering assets, missing ones may just not have been found yet
+    if (assetRegistry.IsLoadingAssets()) {
+        UE_LOG(BlueprintSourceMapSub, Display, TEXT("Waiting for the asset registry to finish discovering assets."));
+        assetRegistry.SearchAllAssets(true);
+    }
+
+    FARFilter filter;
+    filter.SoftObjectPaths.Reserve(blueprintPaths.Num());
+    for (const FString& blueprintPath : blueprintPaths) {
+        filter.SoftObjectPaths.Add(FSoftObjectPath(blueprintPath));
+    }
+
+    TArray<FAssetData> assets;
+    assetRegistry.GetAssets(filter, assets);
+
+    // A redirector left behind by a move still resolves to the blueprint so it counts
+    TSet<FString> existingBlueprints;
+    existingBlueprints.Reserve(assets.Num());
+    for (const FAssetData& asset : assets) {
+        UClass* assetClass = asset.GetClass();
+        if (asset.IsRedirector() || (assetClass != nullptr && assetClass->IsChildOf<UBlueprint>())) {
+            existingBlueprints.Add(asset.GetSoftObjectPath().ToString());
+        }
+    }
+    return existingBlueprints;
+}
+
+void UBlueprintSourceMap::SetMapping(const FString& blueprintPath, const FBlueprintSourceModel& model) {
+    EnsureShardLoaded(blueprintPath);
+    StoreMapping(blueprintPath, model);
+    MarkDirty(blueprintPath);
+}
+
+void UBlueprintSourceMap::RemoveMapping(const FString& blueprintPath) {
+    EnsureShardLoaded(blueprintPath);
+    if (EraseMapping(blueprintPath)) {
+        MarkDirty(blueprintPath);
+    }
+}
+
+/**
+ * Schedules a save for SaveDelaySeconds from now, pushing back the one that's already scheduled.
+ */
+void UBlueprintSourceMap::MarkDirty(const FString& blueprintPath) {
+    _dirtyBlueprintPaths.Add(blueprintPath);
+    _saveTime = FPlatformTime::Seconds() + SaveDelaySeconds;
+
+    if (!_saveTickerHandle.IsValid()) {
+        _saveTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UBlueprintSourceMap::OnSaveTick), 0.5f);
+    }
+
+    // Make sure nothing is lost if the editor closes before the save
+    if (!_preExitHandle.IsValid()) {
+        _preExitHandle = FCoreDelegates::OnEnginePreExit.AddUObject(this, &UBlueprintSourceMap::OnEnginePreExit);
+    }
+}
+
+bool UBlueprintSourceMap::OnSaveTick(float deltaTime) {
+    if (FPlatformTime::Seconds() < _saveTime) {
+        return true; // Keep waiting
+    }
+
+    _saveTickerHandle.Reset();
+    Flush();
+    return false;
+}
+
+void UBlueprintSourceMap::OnEnginePreExit() {
+    Flush();
+}
+
+bool UBlueprintSourceMap::LoadModelFromFile(const FString& filePath, FBlueprintSourceMapModel& outModel) {
+    FString fileContents;
+    if (!FFileHelper::LoadFileToString(fileContents, *filePath)) {
+        // The file is there but we couldn't load it. That's strange.
+        UE_LOG(BlueprintSourceMapSub, Error, TEXT("Failed to load %s for automatic update support."), *filePath);
+        return false;
+    }
+
+    // Parse into JSON
+    if (!FJsonObjectConverter::JsonObjectStringToUStruct(fileContents, &outModel, 0, 0)) {
+        UE_LOG(BlueprintSourceMapSub, Error, TEXT("The blueprint source map at %s was not deserialized from JSON properly. Could the file be corrupt?"), *filePath);
+        return false;
+    }
+
+    return true;
+}
+
+bool UBlueprintSourceMap::SaveModelToFile(const FBlueprintSourceMapModel& model, const FString& filePath) {
+    FString jsonString = TEXT("");
+    if (!FJsonObjectConverter::UStructToJsonObjectString(model, jsonString)) {
+        UE_LOG(BlueprintSourceMapSub, Error, TEXT("Failed to convert blueprint source mappings to json!"));
+        return false;
+    }
+
+    // Make sure the directory exists and create it if it doesn't
+    FString directory = FPaths::GetPath(filePath);
+    if (!FPaths::DirectoryExists(directory)) {
+        IFileManager& fileManager = IFileManager::Get();
+
+        if (!fileManager.MakeDirectory(*directory, true)) {
+            UE_LOG(BlueprintSourceMapSub, Error, TEXT("Failed to save blueprint source mappings to file. The directory did not exist and we could not create it: %s!"), *filePath);
+            return false;
+        }
+    }
+
+    if (!FFileHelper::SaveStringToFile(jsonString, *filePath)) {
+        UE_LOG(BlueprintSourceMapSub, Error, TEXT("Failed to save blueprint source mappings to file %s!"), *filePath);
+        return false;
+    }
+
+    return true;
+}
+
+FString UBlueprintSourceMap::GetShardDirectory() {
+    return FPaths::Combine(_sourceMapDir, ShardDirectoryName);
+}
+
+FString UBlueprintSourceMap::GetShardFilePath(const FString& shardName) {
+    return FPaths::Combine(GetShardDirectory(), shardName + TEXT(".json"));
+}
+
+/**
+ * Returns the name of the shard the given blueprint's mapping is stored in. This is
+ * the content folder the blueprint is in with dots instead of slashes.
+ * For example "/Game/UI/WBP_Menu.WBP_Menu" is stored in "Game.UI".
+ * Note: If two folders end up with the same shard name they just share a file.
+ */
+FString UBlueprintSourceMap::GetShardName(const FString& blueprintPath) {
+    FString folderPath = FPackageName::GetLongPackagePath(FPackageName::ObjectPathToPackageName(blueprintPath));
+    folderPath.RemoveFromStart(TEXT("/"));
+    return folderPath.Replace(TEXT("/"), TEXT("."), ESearchCase::CaseSensitive);
+}
+
+void UBlueprintSourceMap::EnsureShardLoaded(const FString& blueprintPath) {
+    if (!_isSharded) {
+        return;
+    }
+
+    FString shardName = GetShardName(blueprintPath);
+    if (!_loadedShards.Contains(shardName)) {
+        LoadShard(shardName);
+    }
+}
+
+void UBlueprintSourceMap::LoadAllShards() {
+    if (!_isSharded || _areAllShardsLoaded) {
+        return;
+    }
+    _areAllShardsLoaded = true;
+    _shardDirectoryTimestamp = IFileManager::Get().GetTimeStamp(*GetShardDirectory());
+
+    TArray<FString> shardFiles;
+    IFileManager::Get().FindFiles(shardFiles, *FPaths::Combine(GetShardDirectory(), TEXT("*.json")), true, false);
+    for (const FString& shardFile : shardFiles) {
+        FString shardName = FPaths::GetBaseFilename(shardFile);
+        if (!_loadedShards.Contains(shardName)) {
+            LoadShard(shardName);
+        }
+    }
+}
+
+/**
+ * Loads or reloads the given shard. Mappings in it that haven't been saved yet are kept.
  */
-bool UBlueprintSourceMap::DoesBlueprintExist(const FString& blueprintPath) {
-    UBlueprint* blueprintObject = Cast<UBlueprint>(StaticLoadObject(UBlueprint::StaticClass(), nullptr, *blueprintPath));
-    return (blueprintObject != nullptr);
+void UBlueprintSourceMap::LoadShard(const FString& shardName) {
+    FString shardFilePath = GetShardFilePath(shardName);
+    bool wasLoaded = _loadedShards.Contains(shardName);
+    _loadedShards.Add(shardName, IFileManager::Get().GetTimeStamp(*shardFilePath));
+
+    // Forget what we had from the shard before if this is a reload
+    if (wasLoaded) {
+        TArray<FString> blueprintPathsToRemove;
+        for (const TPair<FString, FBlueprintSourceModel>& entry : _sourceMap.BlueprintSourceMap) {
+            if (!_dirtyBlueprintPaths.Contains(entry.Key) && GetShardName(entry.Key) == shardName) {
+                blueprintPathsToRemove.Add(entry.Key);
+            }
+        }
+        for (const FString& blueprintPath : blueprintPathsToRemove) {
+            EraseMapping(blueprintPath);
+        }
+    }
+
+    if (!FPaths::FileExists(shardFilePath)) {
+        return;
+    }
+
+    FBlueprintSourceMapModel shardModel;
+    if (LoadModelFromFile(shardFilePath, shardModel)) {
+        for (TPair<FString, FBlueprintSourceModel>& entry : shardModel.BlueprintSourceMap) {
+            if (!_dirtyBlueprintPaths.Contains(entry.Key)) {
+                StoreMapping(entry.Key, entry.Value);
+            }
+        }
+    }
+}
+
+/**
+ * Writes the shards that have changes. Every other shard is left alone.
+ */
+bool UBlueprintSourceMap::SaveShards() {
+    TMap<FString, FBlueprintSourceMapModel> dirtyShards;
+    for (const FString& blueprintPath : _dirtyBlueprintPaths) {
+        dirtyShards.FindOrAdd(GetShardName(blueprintPath));
+    }
+
+    for (const TPair<FString, FBlueprintSourceModel>& entry : _sourceMap.BlueprintSourceMap) {
+        if (FBlueprintSourceMapModel* shardModel = dirtyShards.Find(GetShardName(entry.Key))) {
+            shardModel->BlueprintSourceMap.Add(entry.Key, entry.Value);
+        }
+    }
+
+    bool isSaved = true;
+    for (TPair<FString, FBlueprintSourceMapModel>& shard : dirtyShards) {
+        FString shardFilePath = GetShardFilePath(shard.Key);
+        if (shard.Value.BlueprintSourceMap.Num() == 0) {
+            // Don't leave empty files behind for folders that no longer have controllers
+            IFileManager::Get().Delete(*shardFilePath, false, false, true);
+        } else {
+            // Keep the order stable so the files diff and merge nicely
+            shard.Value.BlueprintSourceMap.KeySort(TLess<FString>());
+            if (!SaveModelToFile(shard.Value, shardFilePath)) {
+                isSaved = false;
+                continue;
+            }
+        }
+        _loadedShards.Add(shard.Key, IFileManager::Get().GetTimeStamp(*shardFilePath));
+    }
+
+    return isSaved;
+}
+
+/**
+ * Splits the single mapping file into shards the first time sharding is used.
+ * The old file is left where it is.
+ */
+void UBlueprintSourceMap::MigrateToShards() {
+    FString legacyFilePath = GetFilePath();
+    if (FPaths::DirectoryExists(GetShardDirectory()) || !FPaths::FileExists(legacyFilePath)) {
+        return;
+    }
+
+    FBlueprintSourceMapModel legacyModel;
+    if (!LoadModelFromFile(legacyFilePath, legacyModel)) {
+        return;
+    }
+
+    UE_LOG(BlueprintSourceMapSub, Display, TEXT("Moving the %d mappings in %s to %s"), legacyModel.BlueprintSourceMap.Num(), *legacyFilePath, *GetShardDirectory());
+    for (TPair<FString, FBlueprintSourceModel>& entry : legacyModel.BlueprintSourceMap) {
+        _loadedShards.Add(GetShardName(entry.Key), FDateTime::MinValue());
+        StoreMapping(entry.Key, entry.Value);
+        _dirtyBlueprintPaths.Add(entry.Key);
+    }
+
+    // This can run on the warm-up thread so save now rather than scheduling it
+    if (SaveShards()) {
+        _dirtyBlueprintPaths.Empty();
+    }
+}
+
+/**
+ * Adds or replaces a mapping and keeps the source index up to date with it.
+ */
+void UBlueprintSourceMap::StoreMapping(const FString& blueprintPath, const FBlueprintSourceModel& model) {
+    EraseMapping(blueprintPath);
+    _sourceMap.BlueprintSourceMap.Add(blueprintPath, model);
+    AddToSourceIndex(blueprintPath, model);
+}
+
+/**
+ * Removes a mapping along with its source index entries. Returns false if there was no mapping.
+ */
+bool UBlueprintSourceMap::EraseMapping(const FString& blueprintPath) {
+    FBlueprintSourceModel model;
+    if (!_sourceMap.BlueprintSourceMap.RemoveAndCopyValue(blueprintPath, model)) {
+        return false;
+    }
+
+    // Only remove the entries that still point at this blueprint
+    for (const FString& sourcePath : { model.HeaderPath, model.CppPath }) {
+        FString normalizedPath = NormalizeSourcePath(sourcePath);
+        const FString* owner = _blueprintPathsBySourcePath.Find(normalizedPath);
+        if (owner != nullptr && owner->Equals(blueprintPath)) {
+            _blueprintPathsBySourcePath.Remove(normalizedPath);
+        }
+    }
+    return true;
+}
+
+void UBlueprintSourceMap::AddToSourceIndex(const FString& blueprintPath, const FBlueprintSourceModel& model) {
+    for (const FString& sourcePath : { model.HeaderPath, model.CppPath }) {
+        if (sourcePath.IsEmpty()) {
+            continue;
+        }
+
+        FString normalizedPath = NormalizeSourcePath(sourcePath);
+        const FString* owner = _blueprintPathsBySourcePath.Find(normalizedPath);
+        if (owner != nullptr && !owner->Equals(blueprintPath)) {
+            UE_LOG(BlueprintSourceMapSub, Warning, TEXT("%s is mapped to both %s and %s"), *sourcePath, **owner, *blueprintPath);
+        }
+        _blueprintPathsBySourcePath.Add(normalizedPath, blueprintPath);
+    }
+}
+
+void UBlueprintSourceMap::RebuildSourceIndex() {
+    _blueprintPathsBySourcePath.Empty(_sourceMap.BlueprintSourceMap.Num() * 2);
+    for (const TPair<FString, FBlueprintSourceModel>& entry : _sourceMap.BlueprintSourceMap) {
+        AddToSourceIndex(entry.Key, entry.Value);
+    }
+}
+
+/**
+ * Converts a source path to the form used as a key in the source index. This is
+ * relative to the project directory with forward slashes. Absolute paths are accepted.
+ */
+FString UBlueprintSourceMap::NormalizeSourcePath(const FString& sourcePath) {
+    FString normalizedPath = sourcePath;
+    FPaths::NormalizeFilename(normalizedPath);
+    if (!FPaths::IsRelative(normalizedPath)) {
+        FPaths::MakePathRelativeTo(normalizedPath, *FPaths::ConvertRelativePathToFull(_projectRootDirectory));
+    }
+    FPaths::CollapseRelativeDirectories(normalizedPath);
+    return normalizedPath;
 }
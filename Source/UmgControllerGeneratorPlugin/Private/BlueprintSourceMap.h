@@ -1,6 +1,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/Ticker.h"
 #include "BlueprintSourceMap.generated.h"
 
 USTRUCT()
@@ -24,9 +25,22 @@ struct FBlueprintSourceMapModel {
     TMap<FString, FBlueprintSourceModel> BlueprintSourceMap;
 };
 
+/**
+ * The mapping a blueprint had when it was removed and when that happened.
+ */
+struct FRemovedBlueprintMapping {
+    FString BlueprintPath;
+    FBlueprintSourceModel Model;
+    double RemovedTime = 0.0;
+};
+
 /**
  * This is a simple mapping from Blueprint Reference Path to
  * the header and cpp file of its parent class (for auto-generated classes only). 
+ *
+ * The mapping is meant to be kept in memory for the whole session. It's reloaded
+ * when the file changes on disk and changes are written back shortly after they're
+ * made so several changes in a row only write the file once.
  */
 UCLASS()
 class UBlueprintSourceMap : public UObject {
@@ -35,12 +49,21 @@ class UBlueprintSourceMap : public UObject {
 public:
     UBlueprintSourceMap(const FObjectInitializer& objectInitializer) : UObject(objectInitializer) { }
     virtual ~UBlueprintSourceMap() { }
+    virtual void BeginDestroy() override;
 
     /**
      * Loads the mappings from the file in sourceMapDir.
      * The mappings should be relative to the given project source directory.
+     * If isSharded is true, the mappings are stored in one file per content folder
+     * instead and each file is only loaded when a mapping in it is needed.
      */
-    void LoadMapping(FString projectSourceDir, FString sourceMapDir);
+    void LoadMapping(FString projectSourceDir, FString sourceMapDir, bool isSharded = false);
+
+    /**
+     * Reloads the mappings if the file was changed since it was loaded or saved.
+     * Changes that haven't been saved yet are kept.
+     */
+    void ReloadIfChanged();
 
     /**
      * Adds a mapping for the given blueprint.
@@ -56,32 +79,141 @@ public:
      *       use absolutePaths = false to get the relative ones.
      */
     FBlueprintSourceModel GetSourcePathsFor(class UBlueprint* blueprint, bool absolutePaths = true);
+    FBlueprintSourceModel GetSourcePathsFor(const FString& blueprintPath, bool absolutePaths = true);
+
+    /**
+     * Returns true if the blueprint at the given reference path has a mapping.
+     */
+    bool HasMapping(const FString& blueprintPath);
+
+    /**
+     * Returns the reference paths of every blueprint that has a mapping, sorted.
+     */
+    TArray<FString> GetBlueprintPaths();
+
+    /**
+     * Moves the mapping of a blueprint that was renamed or moved.
+     * @return Returns false if there was no mapping for the old path.
+     */
+    bool RenameBlueprint(const FString& oldBlueprintPath, const FString& newBlueprintPath);
+
+    /**
+     * Removes the mapping of a blueprint that was deleted. The mapping is remembered for a few
+     * seconds so it can be restored if a blueprint with the same name is added right after.
+     * @return Returns false if there was no mapping for the blueprint.
+     */
+    bool RemoveBlueprint(const FString& blueprintPath);
+
+    /**
+     * Gives a blueprint the mapping of a blueprint with the same name that was just removed. This
+     * happens when a blueprint is moved outside of the editor, for example by source control.
+     * @return Returns false if exactly one blueprint with that name wasn't just removed.
+     */
+    bool RestoreBlueprint(const FString& blueprintPath);
+    bool HasRemovedBlueprints() const { return _removedBlueprints.Num() > 0; }
+
+    /**
+     * Points the mapping that uses the given header or cpp file at its new location.
+     * @return Returns false if no blueprint is mapped to the old file.
+     */
+    bool MoveSourceFile(const FString& oldSourcePath, const FString& newSourcePath);
+
+    /**
+     * Returns the reference path of the blueprint whose controller is in the given header or cpp file
+     * or an empty string if there isn't one. The path can be absolute or relative to the project directory.
+     */
+    FString GetBlueprintPathFor(const FString& sourcePath);
 
     /**
      * Saves the current mapping to disk. Returns false if it failed.
      */
     bool SaveMapping();
 
+    /**
+     * Saves the mapping now if it has changes that haven't been saved yet.
+     */
+    bool Flush();
+
     /**
      * If you move or rename a file, call UpdateMappings to try to correct them all.
      * Note: This assumes that the name of each file is the name of the class without
      *       the U prefix. If it's not, you will need to manually update the mapping in
      *       the BlueprintSourceMap.json file.
+     * @param excludedDirectories Names (or wildcards) of directories under the Source directories to skip.
+     * @param extensions The extensions (with the dot) of the files to consider.
      * @return Returns false if it failed to save the new mapping.
      */
-    bool UpdateMappings(const TArray<UBlueprint*>& files, FString nameSuffix);
+    bool UpdateMappings(const TArray<UBlueprint*>& files, FString nameSuffix, const TArray<FString>& excludedDirectories, const TArray<FString>& extensions);
+
+    /**
+     * Returns the blueprints in the given list that exist. This asks the asset registry
+     * so none of them have to be loaded.
+     * @param blueprintPaths The reference paths to the blueprints (For example "/Game/SomeSubFolder/WBP_AnotherExample.WBP_AnotherExample")
+     */
+    static TSet<FString> FindExistingBlueprints(const TArray<FString>& blueprintPaths);
 
 private: // Methods
     FString GetFilePath();
-    bool DoesBlueprintExist(const FString& blueprintPath);
+    TArray<FString> GetSourceDirectories();
+    void SetMapping(const FString& blueprintPath, const FBlueprintSourceModel& model);
+    void RemoveMapping(const FString& blueprintPath);
+    void StoreMapping(const FString& blueprintPath, const FBlueprintSourceModel& model);
+    bool EraseMapping(const FString& blueprintPath);
+    void AddToSourceIndex(const FString& blueprintPath, const FBlueprintSourceModel& model);
+    void RebuildSourceIndex();
+    FString NormalizeSourcePath(const FString& sourcePath);
+    void MarkDirty(const FString& blueprintPath);
+    bool OnSaveTick(float deltaTime);
+    void OnEnginePreExit();
+    FString GetShardDirectory();
+    FString GetShardFilePath(const FString& shardName);
+    void EnsureShardLoaded(const FString& blueprintPath);
+    void LoadAllShards();
+    void LoadShard(const FString& shardName);
+    bool SaveShards();
+    void MigrateToShards();
+    void PurgeRemovedBlueprints();
+    static FString GetShardName(const FString& blueprintPath);
+    static bool LoadModelFromFile(const FString& filePath, FBlueprintSourceMapModel& outModel);
+    static bool SaveModelToFile(const FBlueprintSourceMapModel& model, const FString& filePath);
 
 private:
     UPROPERTY()
     FBlueprintSourceMapModel _sourceMap;
 
+    // Normalized header or cpp path to the blueprint it's mapped to
+    TMap<FString, FString> _blueprintPathsBySourcePath;
+
+    // Blueprints that were just removed with the mapping they had. A move outside the editor
+    // is a remove and an add close together so they're only kept for a few seconds.
+    TArray<FRemovedBlueprintMapping> _removedBlueprints;
+    const static inline double RemovedBlueprintLifetimeSeconds = 5.0;
+
     FString _projectRootDirectory;
     FString _sourceMapDir;
 
+    // Modification time of the file when we last loaded or saved it
+    FDateTime _fileTimestamp = FDateTime::MinValue();
+
+    // In sharded mode, each loaded shard and its modification time when we last loaded or saved it
+    bool _isSharded = false;
+    TMap<FString, FDateTime> _loadedShards;
+    bool _areAllShardsLoaded = false;
+
+    // Modification time of the shard directory when every shard was loaded. It changes when a shard is added.
+    FDateTime _shardDirectoryTimestamp = FDateTime::MinValue();
+
+    // Blueprints whose mapping changed since the last save. The save happens once
+    // no more changes have been made for SaveDelaySeconds.
+    TSet<FString> _dirtyBlueprintPaths;
+    double _saveTime = 0.0;
+    FTSTicker::FDelegateHandle _saveTickerHandle;
+    FDelegateHandle _preExitHandle;
+
     // This class' mapping is serialized to the following file in the plugin directory.
     const static inline FString SourceMapFileName = TEXT("BlueprintSourceMap.json");
+
+    // In sharded mode, the shards go in this directory instead
+    const static inline FString ShardDirectoryName = TEXT("BlueprintSourceMap");
+    const static inline float SaveDelaySeconds = 2.0f;
 };
@@ -8,10 +8,29 @@
 #include "FileHelpers.h"
 #include "WidgetBlueprint.h"
 #include "BlueprintSourceMap.h" 	
+#include "SectionSplicer.h"
+#include "CodeTemplate.h"
+#include "SourceFile.h"
+#include "ControllerGenerationJob.h"
+#include "WidgetTreeSnapshot.h"
+#include "Blueprint/WidgetTree.h"
 #include "Modules/ModuleManager.h"
 #include "Widgets/Notifications/SNotificationList.h"
 #include "Framework/Notifications/NotificationManager.h"
+#include "Framework/Application/SlateApplication.h"
 #include "FileCreationProcess.h"
+#include "Async/Async.h"
+#include "Misc/ScopedSlowTask.h"
+#include "Misc/PackageName.h"
+#include "HAL/ThreadSafeBool.h"
+#include "UObject/StrongObjectPtr.h"
+#include "UObject/UObjectIterator.h"
+#include "UObject/UObjectHash.h"
+#include "UObject/Package.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "DirectoryWatcherModule.h"
+#include "IDirectoryWatcher.h"
 
 DEFINE_LOG_CATEGORY_STATIC(CodeGeneratorSub, Log, All);
 
@@ -86,58 +105,85 @@ const FString IncludeSectionStartMarker = TEXT("[START_GENERATED_INCLUDES_SECTIO
 const FString IncludeSectionEndMarker = TEXT("[END_GENERATED_INCLUDES_SECTION]");
 const FString MethodSectionStartMarker = TEXT("[START_GENERATED_METHODS_SECTION]");
 const FString MethodSectionEndMarker = TEXT("[END_GENERATED_METHODS_SECTION]");
-const FString BindWidgetLabel = TEXT("UPROPERTY(BlueprintReadOnly, meta = (BindWidget))");
 const FString WidgetNameMarker = TEXT("[WIDGET_NAME]");
 const FString WidgetSuffixMarker = TEXT("[WIDGET_SUFFIX]");
 const FString WidgetPathMarker = TEXT("[WIDGET_PATH]");
 const FString HeaderFileNameMarker = TEXT("[HEADER_FILE_NAME]");
-const FString WidgetLineMarker = TEXT("static const inline FString WidgetPath = ");
+
+// The placeholders in the templates. A placeholder's slot is its index in this list.
+const TArray<FString> TemplatePlaceholders = {
+    WidgetNameMarker,
+    WidgetSuffixMarker,
+    WidgetPathMarker,
+    HeaderFileNameMarker,
+    PropertiesSectionStartMarker,
+    PropertiesSectionEndMarker,
+    LoaderSectionStartMarker,
+    LoaderSectionEndMarker,
+    IncludeSectionStartMarker,
+    IncludeSectionEndMarker,
+    MethodSectionStartMarker,
+    MethodSectionEndMarker
+};
 
 UCodeGenerator::UCodeGenerator(const FObjectInitializer& initializer) {
-    _config = CreateDefaultSubobject<UCodeGeneratorConfig>(TEXT("Config"));
-    _headerFileTemplate = FillHeaderTemplateSections(MarkedHeaderFileTemplate);
-	_cppFileTemplate = FillCppTemplateSections(MarkedCppFileTemplate);
+    // Use the settings object itself so changes made in the Project Settings apply right away
+    _config = GetMutableDefault<UCodeGeneratorConfig>();
 }
 
-/**
- * Replaces each occurrence of a marker (key) with its value in the source string.
- * @param source The source text (template).
- * @param sections Array of <marker, value> pairs to replace.
- * @return The modified string.
- */
-FString UCodeGenerator::ReplaceSections(const FString& source, const TSections& sections)
-{
-    FString result = source;
-    for (const TSection& pair : sections)
-    {
-        result = result.Replace(*pair.Key, *pair.Value, ESearchCase::CaseSensitive);
+void UCodeGenerator::BeginDestroy() {
+    // The worker uses objects we own so don't let them go out from under it
+    if (_warmUpTask.IsValid()) {
+        _warmUpTask.Wait();
     }
-    return result;
+    for (TFuture<void>& generationTask : _generationTasks) {
+        generationTask.Wait();
+    }
+    _generationTasks.Empty();
+    if (_generationTickerHandle.IsValid()) {
+        FTSTicker::GetCoreTicker().RemoveTicker(_generationTickerHandle);
+        _generationTickerHandle.Reset();
+    }
+    StopWatchingAssets();
+    Super::BeginDestroy();
 }
 
-FString UCodeGenerator::FillHeaderTemplateSections(const FString headerTemplate) {
-	TSections headerSectionsValues = {
-		{ PropertiesSectionStartMarker, *GetGeneratedPropertiesPrefix() },
-		{ PropertiesSectionEndMarker, *GetGeneratedPropertiesSuffix() },
-		{ LoaderSectionStartMarker, *GetGeneratedLoaderPrefix() },
-		{ LoaderSectionEndMarker, *GetGeneratedLoaderSuffix() }
-	};
+TSharedRef<const FWidgetTreeSnapshot, ESPMode::ThreadSafe> UCodeGenerator::CreateSnapshot(UWidgetBlueprint* blueprint) {
+    TSharedRef<FWidgetTreeSnapshot, ESPMode::ThreadSafe> snapshot = MakeShared<FWidgetTreeSnapshot, ESPMode::ThreadSafe>();
 
-	return ReplaceSections(headerTemplate, headerSectionsValues);
-}
+    snapshot->WidgetName = blueprint->GetName();
+    FString wbpPrefix = TEXT("WBP_");
+    if (snapshot->WidgetName.StartsWith(wbpPrefix)) {
+        snapshot->WidgetName = snapshot->WidgetName.RightChop(wbpPrefix.Len());
+    }
+
+    // The controller loads the blueprint by its package path so we don't need the extension
+    snapshot->BlueprintObjectPath = blueprint->GetPathName();
+    snapshot->BlueprintPath = snapshot->BlueprintObjectPath;
+    int dotIndex = -1;
+    if (snapshot->BlueprintPath.FindLastChar(TEXT('.'), dotIndex)) {
+        snapshot->BlueprintPath = snapshot->BlueprintPath.Left(dotIndex);
+    }
+
+    TArray<UWidget*> widgets;
+    blueprint->WidgetTree->ForEachWidget([&widgets] (UWidget* widget) {
+        UE_LOG(CodeGeneratorSub, Verbose, TEXT("Widget: %s of type %s"), *widget->GetName(), *widget->GetClass()->GetName());
+        widgets.Add(widget);
+    });
 
-FString UCodeGenerator::FillCppTemplateSections(const FString cppTemplate) {
-	TSections cppSectionsValues = {
-		{ IncludeSectionStartMarker, *GetGeneratedIncludesPrefix() },
-		{ IncludeSectionEndMarker, *GetGeneratedIncludesSuffix() },
-		{ MethodSectionStartMarker, *GetGeneratedMethodsPrefix() },
-		{ MethodSectionEndMarker, *GetGeneratedMethodsSuffix() }
-	};
+    // Only the widgets that are not the default name get a property
+    TArray<UWidget*> namedWidgets = GetNamedWidgets(widgets);
+    snapshot->Widgets.Reserve(namedWidgets.Num());
+    for (UWidget* widget : namedWidgets) {
+        // Get the first non-generated class
+        UClass* widgetClass = GetFirstNonGeneratedParent(widget->GetClass());
+        snapshot->Widgets.Add({ widget->GetName(), widgetClass->GetName(), GetIncludePathFor(widget) });
+    }
 
-	return ReplaceSections(cppTemplate, cppSectionsValues);
+    return snapshot;
 }
 
-void UCodeGenerator::CreateFiles(UWidgetBlueprint* blueprint, FString widgetPath, FString widgetName, FString widgetSuffix, const TArray<UWidget*>& widgets, FString headerPath, FString cppPath) {
+void UCodeGenerator::CreateFiles(UWidgetBlueprint* blueprint, const TSharedRef<const FWidgetTreeSnapshot, ESPMode::ThreadSafe>& snapshot, FString widgetSuffix, FString headerPath, FString cppPath) {
     if (_currentProcess == nullptr) {
         _currentProcess = NewObject<UFileCreationProcess>();
 
@@ -154,349 +200,651 @@ void UCodeGenerator::CreateFiles(UWidgetBlueprint* blueprint, FString widgetPath
         }
     }
 
-    FString className = widgetName + widgetSuffix;
+    // The user can take a while picking where the files go so don't keep the blueprint alive for it
+    TWeakObjectPtr<UWidgetBlueprint> weakBlueprint = blueprint;
+    FString className = snapshot->WidgetName + widgetSuffix;
     _currentProcess->Start(
         className,
-        [this, widgetPath, widgetName, widgetSuffix, widgets, className, blueprint] (FString headerFilePath, FString cppFilePath) {
-            // Get the widgets that are not the default name
-            TArray<UWidget*> namedWidgets = GetNamedWidgets(widgets);
-
-            // Make the header from the template
+        [this, snapshot, widgetSuffix, className, weakBlueprint] (FString headerFilePath, FString cppFilePath) {
+            // Make the files from the templates on the game thread since they can be reloaded from disk
+            FControllerGenerationJob job = PrepareJob(snapshot, headerFilePath, cppFilePath);
             FString headerFileName = FPaths::GetBaseFilename(headerFilePath);
-            FString headerFileStr = _headerFileTemplate;
-            headerFileStr = headerFileStr.Replace(*WidgetNameMarker, *widgetName);
-            headerFileStr = headerFileStr.Replace(*WidgetSuffixMarker, *widgetSuffix);
-            headerFileStr = headerFileStr.Replace(*WidgetPathMarker, *widgetPath);
-            headerFileStr = headerFileStr.Replace(*HeaderFileNameMarker, *headerFileName);
-
-            // Fill in the dynamic content
-            FString updatedHeaderFileContents = UpdateHeaderFile(namedWidgets, headerFileStr, widgetPath);
-            if (updatedHeaderFileContents.IsEmpty()) {
-                ReportError(FString::Printf(TEXT("Failed to update the header file at %s"), *headerFilePath));
-                return;
-            }
-
-            // Make the CPP from the template
-            FString cppFileStr = _cppFileTemplate;
-            cppFileStr = cppFileStr.Replace(*WidgetNameMarker, *widgetName);
-            cppFileStr = cppFileStr.Replace(*WidgetSuffixMarker, *widgetSuffix);
-            cppFileStr = cppFileStr.Replace(*HeaderFileNameMarker, *headerFileName);
+            job.NewHeaderContents = RenderTemplate(GetHeaderTemplate(), snapshot->WidgetName, widgetSuffix, snapshot->BlueprintPath, headerFileName);
+            job.NewCppContents = RenderTemplate(GetCppTemplate(), snapshot->WidgetName, widgetSuffix, snapshot->BlueprintPath, headerFileName);
 
-            // Fill in the dynamic content
-            FString updatedCppFileContents = UpdateCppFile(namedWidgets, cppFileStr);
-            if (updatedCppFileContents.IsEmpty()) {
-                ReportError(FString::Printf(TEXT("Failed to update the cpp file at %s"), *cppFilePath));
-                return;
-            }
-
-            // Save both to a file
-            if (!FFileHelper::SaveStringToFile(updatedHeaderFileContents, *headerFilePath)) {
-                ReportError(FString::Printf(TEXT("Failed to save the header file to %s"), *headerFilePath));
-                return;
-            }
-            if (!FFileHelper::SaveStringToFile(updatedCppFileContents, *cppFilePath)) {
-                ReportError(FString::Printf(TEXT("Failed to save the cpp file to %s"), *cppFilePath));
-                return;
-            }
-
-            // Update the header map
-            UBlueprintSourceMap* sourceMap = NewObject<UBlueprintSourceMap>();
-            sourceMap->LoadMapping(FPaths::ProjectDir(), GetBlueprintSourceFilePath());
-            sourceMap->AddMapping(blueprint, headerFilePath, cppFilePath);
-            sourceMap->SaveMapping();
-
-            // Trigger a live compile for the changes
-            ILiveCodingModule* liveCoding = FModuleManager::GetModulePtr<ILiveCodingModule>(LIVE_CODING_MODULE_NAME);
-            if (liveCoding != nullptr && liveCoding->IsEnabledForSession())	{
-                if (liveCoding->AutomaticallyCompileNewClasses()) {
-                    if (IsAutoReparentingEnabled()) {
-                        // Setup the patch complete callback and trigger a compile. This will let us reparent
-                        // the class when the compile has finished in the blueprint so the user doesn't have to.
-                        FString capturedClassName = className;
-                        _onPatchingComplete = [this, blueprint, capturedClassName] () {
-                            // There doesn't appear to be a way to get the result of the last compile
-                            // from the live coding module, so we'll assume it succeeded and check
-                            // if reparenting fails later. The user will see the output in the console
-                            // either way.
-                            UE_LOG(CodeGeneratorSub, Display, TEXT("Compile finished."));
-
-                            // Now that the compile is done, lookup the class by name:
-                            UClass* resultClass = nullptr;
-                            for (TObjectIterator<UClass> uclassIterator; uclassIterator; ++uclassIterator) {
-                                FString nameToTest = uclassIterator->GetName();
-                                if (nameToTest == capturedClassName) {
-                                    resultClass = *uclassIterator;
-                                    break;
-                                }
-                            }
-
-                            if (resultClass != nullptr) {
-                                UE_LOG(CodeGeneratorSub, Display, TEXT("Reparenting to the new class."));
-                                UBlueprintEditorLibrary::ReparentBlueprint(blueprint, resultClass);
-
-                                // ReparentBlueprint doesn't save the blueprint after compiling so it won't work
-                                // after restarting the editor. So we need to save it manually
-                                TArray<UPackage*> packagesToSave;
-                                packagesToSave.Add(blueprint->GetOutermost());
-                                FEditorFileUtils::EPromptReturnCode result = FEditorFileUtils::PromptForCheckoutAndSave( 
-                                    packagesToSave,
-                                    false, // bCheckDirty, 
-                                    false // bPromptToSave
-                                );
-
-                                if (result != FEditorFileUtils::EPromptReturnCode::PR_Success) {
-                                    ReportError(FString::Printf(TEXT("There was an issue saving the blueprint after reparenting. You will need to reparent manually.")));
-                                } else {
-                                    ShowSuccessMessage(TEXT("Class created and reparenting complete."));
-                                }
-                            } else {
-                                ReportError(FString::Printf(TEXT("Could not find the generated class. You will need to reparent manually.")));
-                            }
-
-                            _onPatchingComplete = nullptr;
-                        };
-                    }
+            // Fill in the dynamic content and save the files on a worker
+            StartJob(MoveTemp(job), [this, weakBlueprint, className, headerFilePath, cppFilePath] (const FControllerGenerationResult& result) {
+                OnFilesCreated(weakBlueprint, className, headerFilePath, cppFilePath);
+            });
+        },
+        [this] (FString errorDescription) {
+            if (!errorDescription.IsEmpty()) {
+                ReportError(FString::Printf(TEXT("Something went wrong creating the controller files: %s"), *errorDescription));
+            } // Else it's just a cancel
+        }
+    );
+}
 
-                    // Invoke a compile
-                    UE_LOG(CodeGeneratorSub, Display, TEXT("Manually invoking compile"));
-                    ELiveCodingCompileFlags flags = ELiveCodingCompileFlags::None;
-                    ELiveCodingCompileResult result = ELiveCodingCompileResult::Failure;
-                    int attempts = 0;
-                    bool succeeded = false;
-                    while (!succeeded) {
-                        succeeded = liveCoding->Compile(flags, &result);
-
-                        // Sometimes the live coding module is still running even though its OnPatchingCompleted delegate
-                        // has fired. However, we know it will be reset shortly so just wait for it. This could be a timer
-                        // so it doesn't block the thread but this is an editor tool and it's very quick so whatever.
-                        if (!succeeded) {
-                            UE_LOG(CodeGeneratorSub, Warning, TEXT("Could not invoke compile. result: %d, attempts: %d"), (int)result, attempts);
-
-                            // Just hang the thread while we wait for the current compile to finish.
-		                    FPlatformProcess::Sleep(0.1f);
-                        }
+/**
+ * Called once the files for a new controller have been written.
+ */
+void UCodeGenerator::OnFilesCreated(TWeakObjectPtr<UWidgetBlueprint> weakBlueprint, FString className, FString headerFilePath, FString cppFilePath) {
+    UWidgetBlueprint* blueprint = weakBlueprint.Get();
+    if (blueprint == nullptr) {
+        ReportWarning(FString::Printf(TEXT("%s was created but its blueprint is gone. Use Update Mappings once it's back."), *className));
+        return;
+    }
 
-                        // Give it about 5 seconds before giving up
-                        attempts++;
-                        if (attempts > 50) {
-                            UE_LOG(CodeGeneratorSub, Warning, TEXT("Exceeded max number of attempts waiting for compilation."));
+    // Update the header map
+    // Note: The source map saves itself shortly after it changes
+    UBlueprintSourceMap* sourceMap = GetBlueprintSourceMap();
+    sourceMap->AddMapping(blueprint, headerFilePath, cppFilePath);
+
+    // Trigger a live compile for the changes
+    ILiveCodingModule* liveCoding = FModuleManager::GetModulePtr<ILiveCodingModule>(LIVE_CODING_MODULE_NAME);
+    if (liveCoding != nullptr && liveCoding->IsEnabledForSession())	{
+        if (liveCoding->AutomaticallyCompileNewClasses()) {
+            if (IsAutoReparentingEnabled()) {
+                // Setup the patch complete callback and trigger a compile. This will let us reparent
+                // the class when the compile has finished in the blueprint so the user doesn't have to.
+                FString capturedClassName = className;
+                _onPatchingComplete = [this, weakBlueprint, capturedClassName] () {
+                    // There doesn't appear to be a way to get the result of the last compile
+                    // from the live coding module, so we'll assume it succeeded and check
+                    // if reparenting fails later. The user will see the output in the console
+                    // either way.
+                    UE_LOG(CodeGeneratorSub, Display, TEXT("Compile finished."));
+
+                    // Now that the compile is done, lookup the class by name:
+                    UClass* resultClass = nullptr;
+                    for (TObjectIterator<UClass> uclassIterator; uclassIterator; ++uclassIterator) {
+                        FString nameToTest = uclassIterator->GetName();
+                        if (nameToTest == capturedClassName) {
+                            resultClass = *uclassIterator;
                             break;
                         }
                     }
 
-                    if (!succeeded) {
-                        ReportError(FString::Printf(TEXT("Failed to trigger a compile. You will need to reparent your class manually to the controller.")));
-                        _onPatchingComplete = nullptr;
+                    UWidgetBlueprint* blueprint = weakBlueprint.Get();
+                    if (blueprint == nullptr) {
+                        ReportError(FString::Printf(TEXT("The blueprint was unloaded during the compile. You will need to reparent manually.")));
+                    } else if (resultClass != nullptr) {
+                        UE_LOG(CodeGeneratorSub, Display, TEXT("Reparenting to the new class."));
+                        UBlueprintEditorLibrary::ReparentBlueprint(blueprint, resultClass);
+
+                        // ReparentBlueprint doesn't save the blueprint after compiling so it won't work
+                        // after restarting the editor. So we need to save it manually
+                        TArray<UPackage*> packagesToSave;
+                        packagesToSave.Add(blueprint->GetOutermost());
+                        FEditorFileUtils::EPromptReturnCode result = FEditorFileUtils::PromptForCheckoutAndSave( 
+                            packagesToSave,
+                            false, // bCheckDirty, 
+                            false // bPromptToSave
+                        );
+
+                        if (result != FEditorFileUtils::EPromptReturnCode::PR_Success) {
+                            ReportError(FString::Printf(TEXT("There was an issue saving the blueprint after reparenting. You will need to reparent manually.")));
+                        } else {
+                            ShowSuccessMessage(TEXT("Class created and reparenting complete."));
+                        }
+                    } else {
+                        ReportError(FString::Printf(TEXT("Could not find the generated class. You will need to reparent manually.")));
                     }
+
+                    _onPatchingComplete = nullptr;
+                };
+            }
+
+            // Invoke a compile
+            UE_LOG(CodeGeneratorSub, Display, TEXT("Manually invoking compile"));
+            ELiveCodingCompileFlags flags = ELiveCodingCompileFlags::None;
+            ELiveCodingCompileResult result = ELiveCodingCompileResult::Failure;
+            int attempts = 0;
+            bool succeeded = false;
+            while (!succeeded) {
+                succeeded = liveCoding->Compile(flags, &result);
+
+                // Sometimes the live coding module is still running even though its OnPatchingCompleted delegate
+                // has fired. However, we know it will be reset shortly so just wait for it. This could be a timer
+                // so it doesn't block the thread but this is an editor tool and it's very quick so whatever.
+                if (!succeeded) {
+                    UE_LOG(CodeGeneratorSub, Warning, TEXT("Could not invoke compile. result: %d, attempts: %d"), (int)result, attempts);
+
+                    // Just hang the thread while we wait for the current compile to finish.
+                    FPlatformProcess::Sleep(0.1f);
+                }
+
+                // Give it about 5 seconds before giving up
+                attempts++;
+                if (attempts > 50) {
+                    UE_LOG(CodeGeneratorSub, Warning, TEXT("Exceeded max number of attempts waiting for compilation."));
+                    break;
                 }
             }
-        },
-        [this] (FString errorDescription) {
-            if (!errorDescription.IsEmpty()) {
-                ReportError(FString::Printf(TEXT("Something went wrong creating the controller files: %s"), *errorDescription));
-            } // Else it's just a cancel
+
+            if (!succeeded) {
+                ReportError(FString::Printf(TEXT("Failed to trigger a compile. You will need to reparent your class manually to the controller.")));
+                _onPatchingComplete = nullptr;
+            }
         }
-    );
+    }
 }
 
-void UCodeGenerator::UpdateFiles(FString widgetName, FString widgetSuffix, FString blueprintPath, const TArray<UWidget*>& widgets, FString headerPath, FString cppPath) {
-    // Get the widgets that are not the default name
-    TArray<UWidget*> namedWidgets = GetNamedWidgets(widgets);
+void UCodeGenerator::UpdateFiles(const TSharedRef<const FWidgetTreeSnapshot, ESPMode::ThreadSafe>& snapshot, FString widgetSuffix, FString headerPath, FString cppPath) {
+    // The snapshot has everything from the widgets so the files can be updated on a worker
+    FString widgetName = snapshot->WidgetName;
+    FControllerGenerationJob job = PrepareJob(snapshot, headerPath, cppPath);
+    StartJob(MoveTemp(job), [this, widgetName] (const FControllerGenerationResult& result) {
+        if (result.WereFilesWritten) {
+            ShowSuccessMessage(FString::Printf(TEXT("%s updated."), *widgetName));
+        } else {
+            ShowSuccessMessage(FString::Printf(TEXT("%s is already up to date."), *widgetName));
+        }
+    });
+}
 
-    // Load each file from disk, replace the areas between the markers with the new data
-    FString headerFileContents;
-    if (!FFileHelper::LoadFileToString(headerFileContents, *headerPath)) {
-        ReportError(FString::Printf(TEXT("Failed to load the header file at %s"), *headerPath));
-        return;
+TArray<FControllerUpdateResult> UCodeGenerator::UpdateAllFiles(const TArray<FString>& blueprintPaths, bool verifyOnly, TArray<FControllerBatchWindow>* outWindows) {
+    TArray<FControllerUpdateResult> results;
+    results.SetNum(blueprintPaths.Num());
+    for (int32 index = 0; index < blueprintPaths.Num(); index++) {
+        results[index].BlueprintPath = blueprintPaths[index];
     }
 
-    FString updatedHeaderFileContents = UpdateHeaderFile(namedWidgets, headerFileContents, blueprintPath);
-    if (updatedHeaderFileContents.IsEmpty()) {
-        ReportError(FString::Printf(TEXT("Failed to update the header file at %s"), *headerPath));
-        return;
-    }
+    // Load everything that's shared up front so it's only done once for the whole batch
+    UBlueprintSourceMap* sourceMap = GetBlueprintSourceMap();
+    GetHeaderLookupTable();
 
-    FString cppFileContents;
-    if (!FFileHelper::LoadFileToString(cppFileContents, *cppPath)) {
-        ReportError(FString::Printf(TEXT("Failed to load the cpp file at %s"), *cppPath));
-        return;
+    // Each blueprint is one step to read and one to write
+    FScopedSlowTask slowTask(blueprintPaths.Num() * 2.0f, FText::FromString(verifyOnly ? TEXT("Verifying controllers") : TEXT("Updating controllers")));
+    if (!IsRunningCommandlet()) {
+        slowTask.MakeDialog(true);
     }
 
-    FString updatedCppFileContents = UpdateCppFile(namedWidgets, cppFileContents);
-    if (updatedCppFileContents.IsEmpty()) {
-        ReportError(FString::Printf(TEXT("Failed to update the cpp file at %s"), *cppPath));
-        return;
-    }
+    // The files are written on workers while the next blueprints are read. Each one only touches its own result.
+    FThreadSafeBool isCancelled = false;
+    TArray<TFuture<void>> writeTasks;
+    writeTasks.Reserve(blueprintPaths.Num());
+    TArray<TPair<FString, FString>> claimedFiles;
+    auto startWriting = [this, &isCancelled, &writeTasks, &claimedFiles] (FControllerGenerationJob&& job, FControllerUpdateResult* result) {
+        // Two blueprints mapped to the same files, or an update that's still running, would write them at the same time
+        if (!TryClaimFiles(job)) {
+            result->Status = EControllerUpdateStatus::Failed;
+            result->Message = FString::Printf(TEXT("%s is already being updated."), *FPaths::GetCleanFilename(job.HeaderPath));
+            return;
+        }
+        if (!job.VerifyOnly) {
+            claimedFiles.Emplace(job.HeaderPath, job.CppPath);
+        }
 
-    // Write both to a file
-    if (!FFileHelper::SaveStringToFile(updatedHeaderFileContents, *headerPath)) {
-        ReportError(FString::Printf(TEXT("Failed to save the header file to %s"), *headerPath));
-        return;
+        writeTasks.Add(Async(EAsyncExecution::ThreadPool, [job = MoveTemp(job), result, &isCancelled] () {
+            if (isCancelled) {
+                return;
+            }
+
+            FControllerGenerationResult generationResult = job.Run();
+            if (!generationResult.Succeeded()) {
+                result->Status = EControllerUpdateStatus::Failed;
+                result->Message = generationResult.ErrorMessage;
+            } else if (!generationResult.WereFilesWritten) {
+                result->Status = EControllerUpdateStatus::UpToDate;
+            } else {
+                result->Status = job.VerifyOnly ? EControllerUpdateStatus::OutOfDate : EControllerUpdateStatus::Updated;
+            }
+        }));
+    };
+
+    // Read the widget trees on the game thread a window at a time. The snapshots don't reference
+    // the blueprints so they can be collected at the end of each window even if their files are
+    // still being written.
+    const uint64 bytesPerMB = 1024 * 1024;
+    uint64 memoryCeiling = (uint64)GetBatchMemoryCeilingMB() * bytesPerMB;
+    int32 maxWindowSize = GetBatchWindowSize() > 0 ? GetBatchWindowSize() : FMath::Max(blueprintPaths.Num(), 1);
+    int32 windowSize = maxWindowSize;
+
+    // Collecting garbage after every blueprint costs far more than it saves so even when the
+    // ceiling can't be met, a window always reads at least this many
+    int32 minWindowSize = FMath::Min(8, maxWindowSize);
+    bool isOverCeilingAfterCollect = false;
+
+    // Async load requests of the blueprints after the one being read by result index. The reads
+    // for all of them are issued right away so they overlap with reading the current blueprint.
+    int32 prefetchCount = GetBatchPrefetchCount();
+    TMap<int32, int32> prefetchRequestIds;
+    int32 nextPrefetchIndex = 0;
+
+    // Blueprints that were prefetched for a window that ended early. They're kept through the
+    // garbage collection so the next window doesn't have to load them again.
+    TMap<int32, TStrongObjectPtr<UObject>> carriedBlueprints;
+
+    // In the editor, only what the batch loads itself is let go of after each window. Whatever
+    // was already loaded belongs to the editor, like the assets that are open.
+    TSet<FName> preloadedPackages;
+    if (!IsRunningCommandlet()) {
+        for (TObjectIterator<UPackage> packageIt; packageIt; ++packageIt) {
+            preloadedPackages.Add(packageIt->GetFName());
+        }
     }
-    if (!FFileHelper::SaveStringToFile(updatedCppFileContents, *cppPath)) {
-        ReportError(FString::Printf(TEXT("Failed to save the header file to %s"), *cppPath));
-        return;
+
+    double startTime = FPlatformTime::Seconds();
+    int32 index = 0;
+    while (index < blueprintPaths.Num() && !isCancelled) {
+        FControllerBatchWindow window;
+        FPlatformMemoryStats windowStartStats = FPlatformMemory::GetStats();
+        window.PeakUsedPhysical = windowStartStats.UsedPhysical;
+
+        // Samples can miss a spike in between them so the process peak is checked too. If it grew,
+        // the new peak happened during this window.
+        auto sampleMemory = [&window, &windowStartStats] () {
+            FPlatformMemoryStats stats = FPlatformMemory::GetStats();
+            window.PeakUsedPhysical = FMath::Max(window.PeakUsedPhysical, stats.UsedPhysical);
+            if (stats.PeakUsedPhysical > windowStartStats.PeakUsedPhysical) {
+                window.PeakUsedPhysical = FMath::Max(window.PeakUsedPhysical, stats.PeakUsedPhysical);
+            }
+        };
+
+        int32 windowStart = index;
+        int32 windowEnd = FMath::Min(windowStart + windowSize, blueprintPaths.Num());
+        while (index < windowEnd) {
+            // Only prefetch within the window since anything past it would just be collected with it
+            nextPrefetchIndex = FMath::Max(nextPrefetchIndex, index + 1);
+            for (; nextPrefetchIndex < FMath::Min(index + 1 + prefetchCount, windowEnd); nextPrefetchIndex++) {
+                const FString& prefetchPath = blueprintPaths[nextPrefetchIndex];
+                if (sourceMap->HasMapping(prefetchPath) && !carriedBlueprints.Contains(nextPrefetchIndex)) {
+                    prefetchRequestIds.Add(nextPrefetchIndex, LoadPackageAsync(FPackageName::ObjectPathToPackageName(prefetchPath)));
+                }
+            }
+
+            int32 resultIndex = index;
+            FControllerUpdateResult& result = results[index];
+            index++;
+
+            slowTask.EnterProgressFrame(1.0f, FText::FromString(FString::Printf(TEXT("Reading %s"), *FPaths::GetBaseFilename(result.BlueprintPath))));
+            if (slowTask.ShouldCancel()) {
+                // The rest are left as cancelled
+                isCancelled = true;
+                break;
+            }
+
+            FBlueprintSourceModel entry = sourceMap->GetSourcePathsFor(result.BlueprintPath);
+            if (!entry.IsValid()) {
+                result.Status = EControllerUpdateStatus::Failed;
+                result.Message = TEXT("No source map entry. Fix the mapping or try Update Mappings.");
+                continue;
+            }
+
+            // If it was prefetched it's usually loaded by now. Otherwise only wait for this one.
+            int32 prefetchRequestId = INDEX_NONE;
+            if (prefetchRequestIds.RemoveAndCopyValue(resultIndex, prefetchRequestId)) {
+                FlushAsyncLoading(prefetchRequestId);
+                sampleMemory();
+            }
+
+            UWidgetBlueprint* blueprint = LoadObject<UWidgetBlueprint>(nullptr, *result.BlueprintPath);
+            sampleMemory();
+            if (blueprint == nullptr) {
+                carriedBlueprints.Remove(resultIndex);
+                result.Status = EControllerUpdateStatus::Failed;
+                result.Message = TEXT("Could not load the widget blueprint.");
+                continue;
+            }
+
+            FControllerGenerationJob job = PrepareJob(CreateSnapshot(blueprint), entry.HeaderPath, entry.CppPath);
+            job.VerifyOnly = verifyOnly;
+            startWriting(MoveTemp(job), &result);
+            carriedBlueprints.Remove(resultIndex);
+            window.BlueprintCount++;
+
+            // Without the async loading thread, the prefetched packages only make progress when the
+            // game thread processes them so give them a slice before moving on. Their reads are still
+            // in flight in the meantime but serializing them can't overlap with reading the widgets.
+            if (prefetchRequestIds.Num() > 0 && !IsAsyncLoadingMultithreaded()) {
+                ProcessAsyncLoading(true, false, PrefetchProcessingSeconds);
+            }
+
+            // Don't wait for the end of the window if it's already over the ceiling
+            sampleMemory();
+            if (memoryCeiling > 0 && window.PeakUsedPhysical > memoryCeiling && window.BlueprintCount >= minWindowSize) {
+                break;
+            }
+        }
+
+        // If the window ended early, what was prefetched for the rest of it hasn't been read yet. Finish
+        // loading those and keep them through the collection rather than loading them again.
+        for (const TPair<int32, int32>& prefetchRequest : prefetchRequestIds) {
+            FlushAsyncLoading(prefetchRequest.Value);
+            if (UObject* prefetchedBlueprint = FindObject<UObject>(nullptr, *blueprintPaths[prefetchRequest.Key])) {
+                carriedBlueprints.Add(prefetchRequest.Key, TStrongObjectPtr<UObject>(prefetchedBlueprint));
+            }
+        }
+        prefetchRequestIds.Empty();
+        sampleMemory();
+
+        // Let go of everything the window loaded. Assets are standalone so they would otherwise stay
+        // loaded. A commandlet has no use for any of them. The editor only lets go of the ones the
+        // batch loaded that aren't being carried into the next window.
+        if (IsRunningCommandlet()) {
+            CollectGarbage(RF_NoFlags);
+        } else {
+            TSet<FName> carriedPackages;
+            for (const TPair<int32, TStrongObjectPtr<UObject>>& carriedBlueprint : carriedBlueprints) {
+                carriedPackages.Add(carriedBlueprint.Value->GetPackage()->GetFName());
+            }
+            ReleaseBatchPackages(preloadedPackages, carriedPackages);
+            CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+        }
+        window.UsedPhysicalAfterCollect = FPlatformMemory::GetStats().UsedPhysical;
+        UE_LOG(CodeGeneratorSub, Display, TEXT("Read %d blueprints with a window size of %d. Peak working set: %llu MB, after collecting garbage: %llu MB"),
+            window.BlueprintCount, windowSize, window.PeakUsedPhysical / bytesPerMB, window.UsedPhysicalAfterCollect / bytesPerMB);
+
+        // If collecting garbage doesn't get under the ceiling, no window size will
+        if (memoryCeiling > 0 && window.UsedPhysicalAfterCollect > memoryCeiling && !isOverCeilingAfterCollect) {
+            isOverCeilingAfterCollect = true;
+            UE_LOG(CodeGeneratorSub, Warning, TEXT("Memory use is %llu MB after collecting garbage which is already over the ceiling of %llu MB. Windows won't go below %d blueprints. Raise BatchMemoryCeilingMB if this is expected."),
+                window.UsedPhysicalAfterCollect / bytesPerMB, memoryCeiling / bytesPerMB, minWindowSize);
+        }
+
+        // Shrink the window while it goes over the ceiling and grow it back once there's plenty of room
+        if (memoryCeiling > 0) {
+            if (window.PeakUsedPhysical > memoryCeiling) {
+                windowSize = FMath::Max(windowSize / 2, minWindowSize);
+            } else if (window.PeakUsedPhysical < memoryCeiling / 2) {
+                windowSize = FMath::Min(windowSize * 2, maxWindowSize);
+            }
+        }
+
+        if (outWindows != nullptr) {
+            outWindows->Add(window);
+        }
     }
 
-    ShowSuccessMessage(FString::Printf(TEXT("%s updated."), *widgetName));
-}
+    // Keep the dialog responsive until they're all done. This has to wait for every task
+    // even after a cancel since they reference the results and the cancel flag.
+    int32 finishedCount = 0;
+    while (finishedCount < writeTasks.Num()) {
+        int32 nowFinishedCount = 0;
+        for (const TFuture<void>& writeTask : writeTasks) {
+            if (writeTask.IsReady()) {
+                nowFinishedCount++;
+            }
+        }
 
-FString UCodeGenerator::UpdateHeaderFile(const TArray<UWidget*>& namedWidgets, FString headerContents, FString blueprintReferencePath) {
-    FString result;
+        slowTask.EnterProgressFrame(nowFinishedCount - finishedCount, FText::FromString(FString::Printf(TEXT("%s controllers (%d of %d)"), verifyOnly ? TEXT("Checking") : TEXT("Writing"), nowFinishedCount, writeTasks.Num())));
+        finishedCount = nowFinishedCount;
+        if (slowTask.ShouldCancel()) {
+            isCancelled = true;
+        }
 
-    // Find the different sections of the file
-    int propertiesSectionStartIndex = headerContents.Find(GetGeneratedPropertiesPrefix());
-    if (propertiesSectionStartIndex < 0) {
-        UE_LOG(CodeGeneratorSub, Error, TEXT("No properties section found in header"));
-        return FString();
+        if (finishedCount < writeTasks.Num()) {
+            FPlatformProcess::Sleep(0.01f);
+        }
     }
 
-    int propertiesSectionEndIndex = headerContents.Find(GetGeneratedPropertiesSuffix());
-    if (propertiesSectionEndIndex < 0) {
-        UE_LOG(CodeGeneratorSub, Error, TEXT("No properties section end found in header"));
-        return FString();
+    for (const TPair<FString, FString>& files : claimedFiles) {
+        ReleaseFiles(files.Key, files.Value);
     }
 
-    result.Append(headerContents.Left(propertiesSectionStartIndex + GetGeneratedPropertiesPrefix().Len()));
-    result.Append(TEXT("\n"));
+    double elapsedSeconds = FPlatformTime::Seconds() - startTime;
+    UE_LOG(CodeGeneratorSub, Display, TEXT("Batch of %d controllers took %.2f s (%.1f per second) prefetching %d blueprints at a time."),
+        blueprintPaths.Num(), elapsedSeconds, elapsedSeconds > 0.0 ? blueprintPaths.Num() / elapsedSeconds : 0.0, prefetchCount);
 
-    // For each named widget, add it to the properties section
-    bool isFirst = true;
-    for (UWidget* widget : namedWidgets) {
-        FString widgetName = widget->GetName();
+    ShowBatchSummary(results);
+    return results;
+}
 
-        // Get the first non-generated class
-        UClass* widgetClass = GetFirstNonGeneratedParent(widget->GetClass());
-        FString widgetClassName = widgetClass->GetName();
+/**
+ * Clears the standalone flag of everything in the packages a batch loaded so the next garbage
+ * collection can unload them. Packages that were loaded before the batch started, have unsaved
+ * changes or are still needed are left alone.
+ */
+void UCodeGenerator::ReleaseBatchPackages(const TSet<FName>& preloadedPackages, const TSet<FName>& keptPackages) {
+    UPackage* transientPackage = GetTransientPackage();
+    for (TObjectIterator<UPackage> packageIt; packageIt; ++packageIt) {
+        UPackage* package = *packageIt;
+        if (package == transientPackage || package->IsDirty() || package->HasAnyPackageFlags(PKG_CompiledIn | PKG_NewlyCreated)
+            || preloadedPackages.Contains(package->GetFName()) || keptPackages.Contains(package->GetFName())) {
+            continue;
+        }
 
-        if (!isFirst)
-            result.Append(TEXT("\n"));
-        result.Append(TEXT("    ") + BindWidgetLabel + TEXT("\n"));
-        result.Append(TEXT("    class U") + widgetClassName + TEXT("* ") + widgetName + TEXT(" = nullptr;\n"));
-
-        isFirst = false;
-    }
-
-    // Write the end section
-    result.Append(GetGeneratedPropertiesSuffix() + TEXT("\n"));
-
-    int generatedLoaderStartIndex = headerContents.Find(GetGeneratedLoaderPrefix());
-    int generatedLoaderEndIndex = headerContents.Find(GetGeneratedLoaderSuffix());
-    if (generatedLoaderStartIndex != INDEX_NONE && generatedLoaderEndIndex != INDEX_NONE) {
-        // Append what was between the end of the property 
-        // section and the beginning of the loading section
-        int startIndex = propertiesSectionEndIndex + GetGeneratedPropertiesSuffix().Len() + 1;
-        int count = generatedLoaderStartIndex - startIndex;
-        FString contentsBetweenPropertiesAndLoader = headerContents.Mid(startIndex, count);
-        result.Append(contentsBetweenPropertiesAndLoader);
-
-        startIndex = generatedLoaderStartIndex;
-        count = (generatedLoaderEndIndex + GetGeneratedLoaderSuffix().Len() + 1) - startIndex;
-        FString currentLoaderSection = headerContents.Mid(startIndex, count);
-
-        // Rebuild the loader section with the current blueprint path
-        int widgetLineStartIndex = currentLoaderSection.Find(WidgetLineMarker);
-        int endOfLineIndex = INDEX_NONE;
-        if (!currentLoaderSection.RightChop(widgetLineStartIndex + 1).FindChar(TEXT('\n'), endOfLineIndex)) {
-            UE_LOG(CodeGeneratorSub, Error, TEXT("No loader section start found in header"));
-            return headerContents;
-        }
-        endOfLineIndex += widgetLineStartIndex + 1;
-        FString newLoaderSection = currentLoaderSection.Left(widgetLineStartIndex);
-        newLoaderSection.Append(WidgetLineMarker);
-        newLoaderSection.Append("TEXT(\"" + blueprintReferencePath + "\");\n");
-        FString remainingLoaderSection = currentLoaderSection.RightChop(endOfLineIndex + 1);
-        newLoaderSection.Append(remainingLoaderSection);
-
-        // Append the new loader section to the result
-        result.Append(newLoaderSection);
-
-        // Add the rest of the file
-        FString afterLoaderSection = headerContents.RightChop(generatedLoaderEndIndex + GetGeneratedLoaderSuffix().Len() + 1);
-        result.Append(afterLoaderSection);
-    } else {
-        UE_LOG(CodeGeneratorSub, Error, TEXT("No loader section start found in header"));
+        ForEachObjectWithPackage(package, [] (UObject* object) {
+            object->ClearFlags(RF_Standalone);
+            return true;
+        });
+    }
+}
+
+/**
+ * Logs the result of each controller in a batch and shows a single notification with the totals.
+ */
+void UCodeGenerator::ShowBatchSummary(const TArray<FControllerUpdateResult>& results) {
+    int32 updatedCount = 0;
+    int32 upToDateCount = 0;
+    int32 outOfDateCount = 0;
+    int32 cancelledCount = 0;
+    TArray<FString> failedNames;
+    for (const FControllerUpdateResult& result : results) {
+        switch (result.Status) {
+            case EControllerUpdateStatus::Updated:
+                updatedCount++;
+                break;
+            case EControllerUpdateStatus::UpToDate:
+                upToDateCount++;
+                break;
+            case EControllerUpdateStatus::OutOfDate:
+                outOfDateCount++;
+                break;
+            case EControllerUpdateStatus::Failed:
+                failedNames.Add(FPaths::GetBaseFilename(result.BlueprintPath));
+                break;
+            default:
+                cancelledCount++;
+                break;
+        }
 
-        // Just write whatever was there before and don't update the loading section.
-        result.Append(headerContents.RightChop(propertiesSectionEndIndex + GetGeneratedPropertiesSuffix().Len() + 1));
+        if (result.Status == EControllerUpdateStatus::Failed) {
+            UE_LOG(CodeGeneratorSub, Error, TEXT("%s: %s"), *result.BlueprintPath, *result.Message);
+        } else if (result.Status == EControllerUpdateStatus::OutOfDate) {
+            UE_LOG(CodeGeneratorSub, Warning, TEXT("%s: %s"), *result.BlueprintPath, LexToString(result.Status));
+        } else {
+            UE_LOG(CodeGeneratorSub, Display, TEXT("%s: %s"), *result.BlueprintPath, LexToString(result.Status));
+        }
     }
 
-    return result;
+    FString message = FString::Printf(TEXT("%d controllers updated, %d already up to date, %d failed"), updatedCount, upToDateCount, failedNames.Num());
+    if (outOfDateCount > 0) {
+        message += FString::Printf(TEXT(", %d out of date"), outOfDateCount);
+    }
+    if (cancelledCount > 0) {
+        message += FString::Printf(TEXT(", %d cancelled"), cancelledCount);
+    }
+    message += TEXT(".");
+
+    // Only name a few of the failures. The rest are in the log.
+    const int32 maxFailedNames = 5;
+    if (failedNames.Num() > 0) {
+        message += TEXT("\nFailed: ");
+        message += FString::Join(TArrayView<FString>(failedNames.GetData(), FMath::Min(failedNames.Num(), maxFailedNames)), TEXT(", "));
+        if (failedNames.Num() > maxFailedNames) {
+            message += TEXT(", ...");
+        }
+    }
+
+    if (failedNames.Num() > 0) {
+        ReportError(message);
+    } else if (outOfDateCount > 0 || cancelledCount > 0) {
+        ReportWarning(message);
+    } else {
+        ShowSuccessMessage(message);
+    }
 }
 
-FString UCodeGenerator::UpdateCppFile(const TArray<UWidget*>& namedWidgets, FString cppContents) {
-    FString result;
+TArray<FString> UCodeGenerator::FindMappedBlueprintsIn(const FString& folderPath) {
+    IAssetRegistry& assetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+    if (assetRegistry.IsLoadingAssets()) {
+        UE_LOG(CodeGeneratorSub, Display, TEXT("Waiting for the asset registry to finish discovering assets."));
+        assetRegistry.SearchAllAssets(true);
+    }
 
-    // Find the different sections of the file
-    int includesSectionStartIndex = cppContents.Find(GetGeneratedIncludesPrefix());
-    if (includesSectionStartIndex < 0) {
-        UE_LOG(CodeGeneratorSub, Error, TEXT("No includes section found in cpp"));
-        return FString();
+    FString packagePath = folderPath;
+    while (packagePath.Len() > 1 && packagePath.EndsWith(TEXT("/"))) {
+        packagePath.LeftChopInline(1);
     }
 
-    int includesSectionEndIndex = cppContents.Find(GetGeneratedIncludesSuffix());
-    if (includesSectionEndIndex < 0) {
-        UE_LOG(CodeGeneratorSub, Error, TEXT("No properties section end found in cpp"));
-        return FString();
+    TArray<FAssetData> assets;
+    assetRegistry.GetAssetsByPath(FName(*packagePath), assets, true);
+
+    // Only the ones with a controller so the rest don't have to be loaded
+    UBlueprintSourceMap* sourceMap = GetBlueprintSourceMap();
+    TArray<FString> blueprintPaths;
+    for (const FAssetData& asset : assets) {
+        if (IsWidgetBlueprint(asset)) {
+            FString blueprintPath = asset.GetObjectPathString();
+            if (sourceMap->HasMapping(blueprintPath)) {
+                blueprintPaths.Add(blueprintPath);
+            }
+        }
     }
 
-    result.Append(cppContents.Left(includesSectionStartIndex + GetGeneratedIncludesPrefix().Len()));
-    result.Append(TEXT("\n"));
+    blueprintPaths.Sort();
+    return blueprintPaths;
+}
 
-    // Get the include for each widget and keep them in a set
-    UHeaderLookupTable* lookupTable = GetHeaderLookupTable();
-    lookupTable->InitTable();
-    UBlueprintSourceMap* sourceMap = NewObject<UBlueprintSourceMap>();
-    sourceMap->LoadMapping(FPaths::ProjectDir(), GetBlueprintSourceFilePath());
-    TSet<FString> includes;
-    for (UWidget* widget : namedWidgets) {
-        UClass* widgetClass = GetFirstNonGeneratedParent(widget->GetClass());
-        FString name = widgetClass->GetName();
-        FString headerFilePath = lookupTable->GetIncludeFilePathFor(name);
-
-        // If the header lookup is empty, check if it's a blueprint we made
-        if (headerFilePath.IsEmpty()) {
-            UBlueprint* blueprint = GetBlueprintForWidget(widget);
-            if (blueprint != nullptr) {
-                FBlueprintSourceModel entry = sourceMap->GetSourcePathsFor(blueprint);
-                if (entry.IsValid()) {
-                    FString gameSourceDir = FPaths::GameSourceDir();
-
-                    // Make the header file path be the relative path of the header to the module source directory
-                    FString relativeHeaderPath = entry.HeaderPath;
-                    if (!FPaths::MakePathRelativeTo(relativeHeaderPath, *gameSourceDir)) {
-                        UE_LOG(CodeGeneratorSub, Warning, TEXT("Could not find a relative path for header file %s"), *entry.HeaderPath);
-                    } else {
-                        // Remove the first part of the path because that will be the module name
-                        int firstSlashIndex = -1;
-                        if (relativeHeaderPath.FindChar(TEXT('/'), firstSlashIndex)) {
-                            relativeHeaderPath = relativeHeaderPath.RightChop(firstSlashIndex + 1);
-                        }
+/**
+ * Collects what the generated sections of a controller are made from. The section markers
+ * can be changed in the settings so they're picked up here on the game thread.
+ */
+FControllerGenerationJob UCodeGenerator::PrepareJob(const TSharedRef<const FWidgetTreeSnapshot, ESPMode::ThreadSafe>& snapshot, FString headerPath, FString cppPath) {
+    FControllerGenerationJob job;
+    job.Snapshot = snapshot;
+    job.HeaderPath = headerPath;
+    job.CppPath = cppPath;
+
+    RefreshSections();
+    job.HeaderSections = _headerSections;
+    job.CppSections = _cppSections;
+    return job;
+}
 
-                        headerFilePath = relativeHeaderPath;
+/**
+ * Returns the include path for the class of the given widget or an empty string if it can't be found.
+ */
+FString UCodeGenerator::GetIncludePathFor(UWidget* widget) {
+    UClass* widgetClass = GetFirstNonGeneratedParent(widget->GetClass());
+    FString headerFilePath = GetHeaderLookupTable()->GetIncludeFilePathFor(widgetClass);
+
+    // If the header lookup is empty, check if it's a blueprint we made
+    if (headerFilePath.IsEmpty()) {
+        UBlueprint* blueprint = GetBlueprintForWidget(widget);
+        if (blueprint != nullptr) {
+            FBlueprintSourceModel entry = GetBlueprintSourceMap()->GetSourcePathsFor(blueprint);
+            if (entry.IsValid()) {
+                FString gameSourceDir = FPaths::GameSourceDir();
+
+                // Make the header file path be the relative path of the header to the module source directory
+                FString relativeHeaderPath = entry.HeaderPath;
+                if (!FPaths::MakePathRelativeTo(relativeHeaderPath, *gameSourceDir)) {
+                    UE_LOG(CodeGeneratorSub, Warning, TEXT("Could not find a relative path for header file %s"), *entry.HeaderPath);
+                } else {
+                    // Remove the first part of the path because that will be the module name
+                    int firstSlashIndex = -1;
+                    if (relativeHeaderPath.FindChar(TEXT('/'), firstSlashIndex)) {
+                        relativeHeaderPath = relativeHeaderPath.RightChop(firstSlashIndex + 1);
                     }
+
+                    headerFilePath = relativeHeaderPath;
                 }
             }
         }
+    }
 
-        if (!headerFilePath.IsEmpty()) {
-            if (!includes.Contains(headerFilePath)) {
-                includes.Add(headerFilePath);
+    if (headerFilePath.IsEmpty()) {
+        UE_LOG(CodeGeneratorSub, Warning, TEXT("Could not find the include path for %s. You may need to restart the editor."), *widgetClass->GetName());
+    }
+
+    return headerFilePath;
+}
+
+/**
+ * Runs the given job on a worker. The result is handled on the game thread on the next tick.
+ * @param onSucceeded Called on the game thread if the job succeeded. Errors are reported to the user.
+ */
+void UCodeGenerator::StartJob(FControllerGenerationJob&& job, TFunction<void(const FControllerGenerationResult&)> onSucceeded) {
+    if (!TryClaimFiles(job)) {
+        ReportWarning(FString::Printf(TEXT("%s is already being updated. Try again once it's done."), *FPaths::GetCleanFilename(job.HeaderPath)));
+        return;
+    }
+
+    _generationTasks.Add(Async(EAsyncExecution::ThreadPool, [this, job = MoveTemp(job), onSucceeded = MoveTemp(onSucceeded)] () mutable {
+        FControllerGenerationResult result = job.Run();
+        _finishedGenerations.Enqueue([this, headerPath = job.HeaderPath, cppPath = job.CppPath, result = MoveTemp(result), onSucceeded = MoveTemp(onSucceeded)] () {
+            ReleaseFiles(headerPath, cppPath);
+            if (!result.Succeeded()) {
+                ReportError(result.ErrorMessage);
+            } else if (onSucceeded) {
+                onSucceeded(result);
             }
-        } else {
-            UE_LOG(CodeGeneratorSub, Warning, TEXT("Could not find the include path for %s. You may need to restart the editor."), *name);
-        }
+        });
+    }));
+
+    if (!_generationTickerHandle.IsValid()) {
+        _generationTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UCodeGenerator::OnGenerationTick));
     }
+}
 
-    for (FString includePath : includes) {
-        result.Append(TEXT("#include \"") + includePath + "\"\n");
+/**
+ * Marks the files a job writes as in use so no other job writes them at the same time.
+ * @return Returns false if another job is already writing either of them.
+ */
+bool UCodeGenerator::TryClaimFiles(const FControllerGenerationJob& job) {
+    if (job.VerifyOnly) {
+        // Nothing is written and files are only ever replaced whole so reading is always safe
+        return true;
     }
 
-    // Finish off the file
-    result.Append(GetGeneratedIncludesSuffix() + TEXT("\n"));
-    result.Append(cppContents.RightChop(includesSectionEndIndex + GetGeneratedIncludesSuffix().Len() + 1));
+    FString headerKey = GetFileKey(job.HeaderPath);
+    FString cppKey = GetFileKey(job.CppPath);
+    if (_filesBeingWritten.Contains(headerKey) || _filesBeingWritten.Contains(cppKey)) {
+        return false;
+    }
 
-    return result;
+    _filesBeingWritten.Add(headerKey);
+    _filesBeingWritten.Add(cppKey);
+    return true;
+}
+
+void UCodeGenerator::ReleaseFiles(const FString& headerPath, const FString& cppPath) {
+    FString headerKey = GetFileKey(headerPath);
+    _filesBeingWritten.Remove(headerKey);
+    _filesBeingWritten.Remove(GetFileKey(cppPath));
+
+    // The blueprint was moved while the job was writing the header with its old path
+    FString widgetPath;
+    if (_pendingWidgetPaths.RemoveAndCopyValue(headerKey, widgetPath) && !UpdateWidgetPath(headerPath, widgetPath)) {
+        ReportWarning(FString::Printf(TEXT("The widget path in %s could not be updated to %s. Use Update Controller to fix it."), *FPaths::GetCleanFilename(headerPath), *widgetPath));
+    }
+}
+
+FString UCodeGenerator::GetFileKey(const FString& filePath) {
+    FString fileKey = FPaths::ConvertRelativePathToFull(filePath);
+    FPaths::NormalizeFilename(fileKey);
+    return fileKey;
+}
+
+bool UCodeGenerator::OnGenerationTick(float deltaTime) {
+    TFunction<void()> finishGeneration;
+    while (_finishedGenerations.Dequeue(finishGeneration)) {
+        finishGeneration();
+    }
+
+    // Stop ticking once everything that was started has been handled
+    _generationTasks.RemoveAll([] (const TFuture<void>& generationTask) {
+        return generationTask.IsReady();
+    });
+    if (_generationTasks.Num() == 0 && _finishedGenerations.IsEmpty()) {
+        _generationTickerHandle.Reset();
+        return false;
+    }
+
+    return true;
 }
 
 /**
@@ -563,13 +911,420 @@ UClass* UCodeGenerator::GetFirstNonGeneratedParent(UClass* inputClass) {
 }
 
 UHeaderLookupTable* UCodeGenerator::GetHeaderLookupTable() {
+    // If the warm-up is still running, waiting for it is quicker than starting over
+    FinishWarmUp();
+
     if (_headerLookupTable == nullptr) {
-        _headerLookupTable = NewObject<UHeaderLookupTable>();
-        _headerLookupTable->InitTable();        
+        _headerLookupTable = NewObject<UHeaderLookupTable>(this);
+        _headerLookupTable->SetLazyIndexing(_config->LazyHeaderIndexing);
+        _headerLookupTable->StartWatching();
     }
+
+    // Note: The table is built the first time a class can't be resolved from its metadata
     return _headerLookupTable;
 }
 
+UBlueprintSourceMap* UCodeGenerator::GetBlueprintSourceMap() {
+    FinishWarmUp();
+
+    if (_blueprintSourceMap == nullptr) {
+        _blueprintSourceMap = NewObject<UBlueprintSourceMap>(this);
+        _blueprintSourceMap->LoadMapping(FPaths::ProjectDir(), GetBlueprintSourceFilePath(), _config->ShardedBlueprintSourceMap);
+    } else {
+        // Pick up changes from source control or another editor
+        _blueprintSourceMap->ReloadIfChanged();
+    }
+    return _blueprintSourceMap;
+}
+
+void UCodeGenerator::StartWarmUp() {
+    if (_warmUpTask.IsValid() || (_headerLookupTable != nullptr && _blueprintSourceMap != nullptr)) {
+        return;
+    }
+
+    // UObjects have to be created on the game thread. Nothing else can see these
+    // until FinishWarmUp so the worker has them to itself in the meantime.
+    if (_headerLookupTable == nullptr) {
+        _warmUpHeaderLookupTable = NewObject<UHeaderLookupTable>(this);
+        _warmUpHeaderLookupTable->SetLazyIndexing(_config->LazyHeaderIndexing);
+    }
+    if (_blueprintSourceMap == nullptr) {
+        _warmUpSourceMap = NewObject<UBlueprintSourceMap>(this);
+    }
+
+    UE_LOG(CodeGeneratorSub, Display, TEXT("Warming up the code generator in the background."));
+    UHeaderLookupTable* headerLookupTable = _warmUpHeaderLookupTable;
+    UBlueprintSourceMap* sourceMap = _warmUpSourceMap;
+    FString projectDir = FPaths::ProjectDir();
+    FString sourceMapDir = GetBlueprintSourceFilePath();
+    bool isSourceMapSharded = _config->ShardedBlueprintSourceMap;
+    TWeakObjectPtr<UCodeGenerator> weakThis(this);
+    _warmUpTask = Async(EAsyncExecution::ThreadPool, [headerLookupTable, sourceMap, projectDir, sourceMapDir, isSourceMapSharded, weakThis] () {
+        double timeBefore = FPlatformTime::Seconds();
+        if (headerLookupTable != nullptr) {
+            // The whole index is built even in lazy mode since nobody is waiting on it
+            headerLookupTable->BuildFullIndex();
+        }
+        if (sourceMap != nullptr) {
+            sourceMap->LoadMapping(projectDir, sourceMapDir, isSourceMapSharded);
+        }
+
+        double elapsedTimeMs = (FPlatformTime::Seconds() - timeBefore) * 1000.0;
+        UE_LOG(CodeGeneratorSub, Display, TEXT("Background warm-up finished in %f ms"), elapsedTimeMs);
+
+        AsyncTask(ENamedThreads::GameThread, [weakThis] () {
+            if (UCodeGenerator* generator = weakThis.Get()) {
+                generator->FinishWarmUp();
+            }
+        });
+    });
+}
+
+/**
+ * Hands what the warm-up loaded over to the generator. If the warm-up is
+ * still running, this waits for it. Must be called on the game thread.
+ */
+void UCodeGenerator::FinishWarmUp() {
+    if (!_warmUpTask.IsValid()) {
+        return;
+    }
+    _warmUpTask.Wait();
+    _warmUpTask.Reset();
+
+    // Only take them if nothing was loaded while we were working
+    if (_headerLookupTable == nullptr && _warmUpHeaderLookupTable != nullptr) {
+        _headerLookupTable = _warmUpHeaderLookupTable;
+        _headerLookupTable->StartWatching();
+    }
+    if (_blueprintSourceMap == nullptr && _warmUpSourceMap != nullptr) {
+        _blueprintSourceMap = _warmUpSourceMap;
+    }
+
+    _warmUpHeaderLookupTable = nullptr;
+    _warmUpSourceMap = nullptr;
+}
+
+void UCodeGenerator::StartWatchingAssets() {
+    if (_isWatchingAssets) {
+        return;
+    }
+    _isWatchingAssets = true;
+
+    IAssetRegistry& assetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+    _assetRenamedHandle = assetRegistry.OnAssetRenamed().AddUObject(this, &UCodeGenerator::OnAssetRenamed);
+    _assetRemovedHandle = assetRegistry.OnAssetRemoved().AddUObject(this, &UCodeGenerator::OnAssetRemoved);
+    _assetAddedHandle = assetRegistry.OnAssetAdded().AddUObject(this, &UCodeGenerator::OnAssetAdded);
+
+    // Catch controller files being moved around outside of the editor
+    FDirectoryWatcherModule& directoryWatcherModule = FModuleManager::LoadModuleChecked<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+    IDirectoryWatcher* directoryWatcher = directoryWatcherModule.Get();
+    if (directoryWatcher != nullptr) {
+        _watchedSourceDirectory = FPaths::ConvertRelativePathToFull(FPaths::GameSourceDir());
+        directoryWatcher->RegisterDirectoryChangedCallback_Handle(
+            _watchedSourceDirectory,
+            IDirectoryWatcher::FDirectoryChanged::CreateUObject(this, &UCodeGenerator::OnSourceDirectoryChanged),
+            _sourceWatcherHandle);
+    }
+}
+
+void UCodeGenerator::StopWatchingAssets() {
+    if (!_isWatchingAssets) {
+        return;
+    }
+    _isWatchingAssets = false;
+
+    // The registry may already be gone if we're shutting down
+    FAssetRegistryModule* assetRegistryModule = FModuleManager::GetModulePtr<FAssetRegistryModule>(TEXT("AssetRegistry"));
+    if (assetRegistryModule != nullptr) {
+        IAssetRegistry& assetRegistry = assetRegistryModule->Get();
+        assetRegistry.OnAssetRenamed().Remove(_assetRenamedHandle);
+        assetRegistry.OnAssetRemoved().Remove(_assetRemovedHandle);
+        assetRegistry.OnAssetAdded().Remove(_assetAddedHandle);
+    }
+    _assetRenamedHandle.Reset();
+    _assetRemovedHandle.Reset();
+    _assetAddedHandle.Reset();
+
+    FDirectoryWatcherModule* directoryWatcherModule = FModuleManager::GetModulePtr<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+    if (directoryWatcherModule != nullptr && directoryWatcherModule->Get() != nullptr && _sourceWatcherHandle.IsValid()) {
+        directoryWatcherModule->Get()->UnregisterDirectoryChangedCallback_Handle(_watchedSourceDirectory, _sourceWatcherHandle);
+    }
+    _sourceWatcherHandle.Reset();
+}
+
+bool UCodeGenerator::IsWidgetBlueprint(const FAssetData& asset) {
+    UClass* assetClass = asset.GetClass();
+    return assetClass != nullptr && assetClass->IsChildOf<UWidgetBlueprint>();
+}
+
+void UCodeGenerator::OnAssetRenamed(const FAssetData& asset, const FString& oldObjectPath) {
+    if (!IsWidgetBlueprint(asset)) {
+        return;
+    }
+
+    UBlueprintSourceMap* sourceMap = GetBlueprintSourceMap();
+    FString newObjectPath = asset.GetSoftObjectPath().ToString();
+    if (!sourceMap->RenameBlueprint(oldObjectPath, newObjectPath)) {
+        return; // Not one of ours
+    }
+
+    FBlueprintSourceModel sourcePaths = sourceMap->GetSourcePathsFor(newObjectPath);
+    if (!UpdateWidgetPath(sourcePaths.HeaderPath, asset.PackageName.ToString())) {
+        ReportWarning(FString::Printf(TEXT("%s was moved but its controller could not be updated. Use Update Controller to fix it."), *asset.AssetName.ToString()));
+    }
+}
+
+void UCodeGenerator::OnAssetRemoved(const FAssetData& asset) {
+    if (!IsWidgetBlueprint(asset)) {
+        return;
+    }
+
+    GetBlueprintSourceMap()->RemoveBlueprint(asset.GetSoftObjectPath().ToString());
+}
+
+void UCodeGenerator::OnAssetAdded(const FAssetData& asset) {
+    // This is called for every asset the registry discovers so get out early
+    if (_blueprintSourceMap == nullptr || !_blueprintSourceMap->HasRemovedBlueprints() || !IsWidgetBlueprint(asset)) {
+        return;
+    }
+
+    // A blueprint that was removed and added again somewhere else was moved outside the editor
+    FString objectPath = asset.GetSoftObjectPath().ToString();
+    if (_blueprintSourceMap->RestoreBlueprint(objectPath)) {
+        FBlueprintSourceModel sourcePaths = _blueprintSourceMap->GetSourcePathsFor(objectPath);
+        UpdateWidgetPath(sourcePaths.HeaderPath, asset.PackageName.ToString());
+    }
+}
+
+void UCodeGenerator::OnSourceDirectoryChanged(const TArray<FFileChangeData>& fileChanges) {
+    // A move shows up as a remove and an add, usually in the same batch but not always in
+    // the same order, so look at the removes first. Removes from earlier batches are kept
+    // for a few seconds in case the add comes separately.
+    double now = FPlatformTime::Seconds();
+    _removedSourceFiles.RemoveAll([now] (const TPair<FString, double>& removed) { return removed.Value < now - RemovedSourceFileLifetimeSeconds; });
+    for (const FFileChangeData& fileChange : fileChanges) {
+        if (fileChange.Action == FFileChangeData::FCA_Removed) {
+            if (!GetBlueprintSourceMap()->GetBlueprintPathFor(fileChange.Filename).IsEmpty()) {
+                _removedSourceFiles.RemoveAll([&fileChange] (const TPair<FString, double>& removed) { return FPaths::IsSamePath(removed.Key, fileChange.Filename); });
+                _removedSourceFiles.Emplace(fileChange.Filename, now);
+            }
+        }
+    }
+
+    if (_removedSourceFiles.Num() == 0) {
+        return;
+    }
+
+    for (const FFileChangeData& fileChange : fileChanges) {
+        if (fileChange.Action != FFileChangeData::FCA_Added) {
+            continue;
+        }
+
+        // Only pair it with a removed file of the same name if there's exactly one
+        FString fileName = FPaths::GetCleanFilename(fileChange.Filename);
+        int32 removedIndex = INDEX_NONE;
+        bool isAmbiguous = false;
+        for (int32 index = 0; index < _removedSourceFiles.Num(); index++) {
+            if (FPaths::GetCleanFilename(_removedSourceFiles[index].Key).Equals(fileName)) {
+                isAmbiguous = removedIndex != INDEX_NONE;
+                removedIndex = index;
+            }
+        }
+
+        if (isAmbiguous) {
+            UE_LOG(CodeGeneratorSub, Warning, TEXT("Several controller files named %s were just removed so the move to %s can't be followed. Use Update Mappings to fix it."), *fileName, *fileChange.Filename);
+        } else if (removedIndex != INDEX_NONE) {
+            FString oldFilePath = _removedSourceFiles[removedIndex].Key;
+            _removedSourceFiles.RemoveAt(removedIndex);
+            GetBlueprintSourceMap()->MoveSourceFile(oldFilePath, fileChange.Filename);
+        }
+    }
+}
+
+/**
+ * Points the loader in the given controller header at the given widget blueprint. If a job is
+ * writing the header, it's done once the job is finished so the job doesn't put the old path back.
+ * @return Returns false if the header couldn't be loaded, saved or has no loader.
+ */
+bool UCodeGenerator::UpdateWidgetPath(const FString& headerPath, const FString& widgetPath) {
+    if (headerPath.IsEmpty()) {
+        return WriteWidgetPath(headerPath, widgetPath);
+    }
+
+    FString headerKey = GetFileKey(headerPath);
+    if (_filesBeingWritten.Contains(headerKey)) {
+        UE_LOG(CodeGeneratorSub, Display, TEXT("%s is being written. Its widget path will be updated to %s once it's done."), *headerPath, *widgetPath);
+        _pendingWidgetPaths.Add(headerKey, widgetPath);
+        return true;
+    }
+
+    _filesBeingWritten.Add(headerKey);
+    bool isUpdated = WriteWidgetPath(headerPath, widgetPath);
+    _filesBeingWritten.Remove(headerKey);
+    return isUpdated;
+}
+
+/**
+ * Rewrites the loader in the given controller header. Nothing else in the header is touched.
+ */
+bool UCodeGenerator::WriteWidgetPath(const FString& headerPath, const FString& widgetPath) {
+    FSourceFile headerFile;
+    if (headerPath.IsEmpty() || !headerFile.Load(headerPath)) {
+        UE_LOG(CodeGeneratorSub, Warning, TEXT("Failed to load the header file at %s"), *headerPath);
+        return false;
+    }
+
+    FString updatedHeaderContents;
+    if (!FControllerGenerationJob::AppendWithWidgetPath(headerFile.Contents, widgetPath, updatedHeaderContents)) {
+        UE_LOG(CodeGeneratorSub, Warning, TEXT("No widget path found in %s"), *headerPath);
+        return false;
+    }
+
+    headerFile.Contents = MoveTemp(updatedHeaderContents);
+    bool wasWritten = false;
+    if (!headerFile.Save(headerPath, wasWritten)) {
+        UE_LOG(CodeGeneratorSub, Warning, TEXT("Failed to save the header file to %s"), *headerPath);
+        return false;
+    }
+    if (!wasWritten) {
+        return true;
+    }
+
+    UE_LOG(CodeGeneratorSub, Display, TEXT("Updated the widget path in %s to %s"), *headerPath, *widgetPath);
+    return true;
+}
+
+/**
+ * Rebuilds the section markers if they have changed in the config since they were last built.
+ */
+void UCodeGenerator::RefreshSections() {
+    uint32 sectionMarkersHash = GetSectionMarkersHash();
+    if (_headerSections.IsValid() && _cppSections.IsValid() && sectionMarkersHash == _sectionMarkersHash) {
+        return;
+    }
+
+    TSharedPtr<FSectionSplicer, ESPMode::ThreadSafe> headerSections = MakeShared<FSectionSplicer, ESPMode::ThreadSafe>();
+    verify(headerSections->AddSection(TEXT("properties"), UnescapeNewlines(_config->GeneratedPropertiesPrefix), UnescapeNewlines(_config->GeneratedPropertiesSuffix)) == PropertiesSectionId);
+    verify(headerSections->AddSection(TEXT("loader"), UnescapeNewlines(_config->GeneratedLoaderPrefix), UnescapeNewlines(_config->GeneratedLoaderSuffix)) == LoaderSectionId);
+    _headerSections = headerSections;
+
+    TSharedPtr<FSectionSplicer, ESPMode::ThreadSafe> cppSections = MakeShared<FSectionSplicer, ESPMode::ThreadSafe>();
+    verify(cppSections->AddSection(TEXT("includes"), UnescapeNewlines(_config->GeneratedIncludesPrefix), UnescapeNewlines(_config->GeneratedIncludesSuffix)) == IncludesSectionId);
+    verify(cppSections->AddSection(TEXT("methods"), UnescapeNewlines(_config->GeneratedMethodsPrefix), UnescapeNewlines(_config->GeneratedMethodsSuffix)) == MethodsSectionId);
+    _cppSections = cppSections;
+
+    _sectionMarkersHash = sectionMarkersHash;
+}
+
+uint32 UCodeGenerator::GetSectionMarkersHash() const {
+    const FString* sectionMarkers[] = {
+        &_config->GeneratedPropertiesPrefix,
+        &_config->GeneratedPropertiesSuffix,
+        &_config->GeneratedLoaderPrefix,
+        &_config->GeneratedLoaderSuffix,
+        &_config->GeneratedIncludesPrefix,
+        &_config->GeneratedIncludesSuffix,
+        &_config->GeneratedMethodsPrefix,
+        &_config->GeneratedMethodsSuffix
+    };
+
+    // Note: GetTypeHash isn't used because it ignores case
+    uint32 hash = 0;
+    for (const FString* sectionMarker : sectionMarkers) {
+        hash = HashCombine(hash, FCrc::StrCrc32(**sectionMarker));
+    }
+    return hash;
+}
+
+const FSectionSplicer& UCodeGenerator::GetHeaderSections() {
+    RefreshSections();
+    return *_headerSections;
+}
+
+const FSectionSplicer& UCodeGenerator::GetCppSections() {
+    RefreshSections();
+    return *_cppSections;
+}
+
+const FCodeTemplate& UCodeGenerator::GetHeaderTemplate() {
+    RefreshTemplate(_headerTemplate, _config->HeaderTemplateFile, MarkedHeaderFileTemplate, TemplatePlaceholders.IndexOfByKey(PropertiesSectionStartMarker));
+    return *_headerTemplate;
+}
+
+const FCodeTemplate& UCodeGenerator::GetCppTemplate() {
+    RefreshTemplate(_cppTemplate, _config->CppTemplateFile, MarkedCppFileTemplate, TemplatePlaceholders.IndexOfByKey(IncludeSectionStartMarker));
+    return *_cppTemplate;
+}
+
+/**
+ * Compiles the given template if it hasn't been compiled yet, the template file in the config
+ * has changed or the file itself has changed since it was compiled.
+ * @param templateFile The template file from the config. Relative paths are relative to the project directory.
+ * @param builtInTemplate The template to use if there's no template file or it can't be loaded.
+ * @param requiredSlot The slot of a placeholder the template needs for the generated file to be updated later.
+ */
+void UCodeGenerator::RefreshTemplate(TSharedPtr<const FCodeTemplate, ESPMode::ThreadSafe>& compiledTemplate, const FString& templateFile, const FString& builtInTemplate, int32 requiredSlot) {
+    FString templateFilePath;
+    if (!templateFile.IsEmpty()) {
+        templateFilePath = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), templateFile);
+    }
+
+    if (compiledTemplate.IsValid() && compiledTemplate->GetFilePath() == templateFilePath && !compiledTemplate->IsFileChanged()) {
+        return;
+    }
+
+    TSharedPtr<FCodeTemplate, ESPMode::ThreadSafe> newTemplate = MakeShared<FCodeTemplate, ESPMode::ThreadSafe>();
+    if (templateFilePath.IsEmpty()) {
+        newTemplate->Compile(builtInTemplate, TemplatePlaceholders);
+    } else if (newTemplate->CompileFile(templateFilePath, TemplatePlaceholders)) {
+        UE_LOG(CodeGeneratorSub, Display, TEXT("Compiled the template at %s"), *templateFilePath);
+        if (!newTemplate->HasPlaceholder(requiredSlot)) {
+            ReportWarning(FString::Printf(TEXT("The template at %s has no %s so its files can't be updated."), *templateFilePath, *TemplatePlaceholders[requiredSlot]));
+        }
+    } else {
+        ReportWarning(FString::Printf(TEXT("Could not load the template at %s. Using the built-in template instead."), *templateFilePath));
+        newTemplate->Compile(builtInTemplate, TemplatePlaceholders);
+    }
+
+    compiledTemplate = newTemplate;
+}
+
+/**
+ * Fills in the given template for a widget.
+ */
+FString UCodeGenerator::RenderTemplate(const FCodeTemplate& codeTemplate, const FString& widgetName, const FString& widgetSuffix, const FString& widgetPath, const FString& headerFileName) {
+    const FSectionSplicer& headerSections = GetHeaderSections();
+    const FSectionSplicer& cppSections = GetCppSections();
+
+    // In the same order as TemplatePlaceholders
+    FStringView values[] = {
+        widgetName,
+        widgetSuffix,
+        widgetPath,
+        headerFileName,
+        headerSections.GetPrefix(PropertiesSectionId),
+        headerSections.GetSuffix(PropertiesSectionId),
+        headerSections.GetPrefix(LoaderSectionId),
+        headerSections.GetSuffix(LoaderSectionId),
+        cppSections.GetPrefix(IncludesSectionId),
+        cppSections.GetSuffix(IncludesSectionId),
+        cppSections.GetPrefix(MethodsSectionId),
+        cppSections.GetSuffix(MethodsSectionId)
+    };
+    check(UE_ARRAY_COUNT(values) == TemplatePlaceholders.Num());
+
+    return codeTemplate.Render(values);
+}
+
+const FString& UCodeGenerator::GetGeneratedMethodsPrefix() { return GetCppSections().GetPrefix(MethodsSectionId); }
+const FString& UCodeGenerator::GetGeneratedMethodsSuffix() { return GetCppSections().GetSuffix(MethodsSectionId); }
+const FString& UCodeGenerator::GetGeneratedIncludesPrefix() { return GetCppSections().GetPrefix(IncludesSectionId); }
+const FString& UCodeGenerator::GetGeneratedIncludesSuffix() { return GetCppSections().GetSuffix(IncludesSectionId); }
+const FString& UCodeGenerator::GetGeneratedLoaderPrefix() { return GetHeaderSections().GetPrefix(LoaderSectionId); }
+const FString& UCodeGenerator::GetGeneratedLoaderSuffix() { return GetHeaderSections().GetSuffix(LoaderSectionId); }
+const FString& UCodeGenerator::GetGeneratedPropertiesPrefix() { return GetHeaderSections().GetPrefix(PropertiesSectionId); }
+const FString& UCodeGenerator::GetGeneratedPropertiesSuffix() { return GetHeaderSections().GetSuffix(PropertiesSectionId); }
+
 /**
  * Returns the blueprint that generated this widget or nullptr if it has none. 
  */
@@ -595,6 +1350,19 @@ FString UCodeGenerator::UnescapeNewlines(const FString& input) {
  * @param reason The reason for the notification.
  */
 void UCodeGenerator::ShowNotification(FString message, ENotificationReason reason) {
+    if (reason == ENotificationReason::Error) {
+        UE_LOG(CodeGeneratorSub, Error, TEXT("%s"), *message);
+    } else if (reason == ENotificationReason::Warning) {
+        UE_LOG(CodeGeneratorSub, Warning, TEXT("%s"), *message);
+    } else if (reason == ENotificationReason::Success) {
+        UE_LOG(CodeGeneratorSub, Display, TEXT("%s"), *message);
+    }
+
+    // There's nowhere to show it when running headless so the log will have to do
+    if (!FSlateApplication::IsInitialized()) {
+        return;
+    }
+
     FNotificationInfo info(FText::FromString(message));
 	info.FadeInDuration = 0.1f;
 	info.FadeOutDuration = 0.5f;
@@ -606,15 +1374,16 @@ void UCodeGenerator::ShowNotification(FString message, ENotificationReason reaso
 	info.bAllowThrottleWhenFrameRateIsLow = false;
 
 	auto notificationItem = FSlateNotificationManager::Get().AddNotification(info);
+    if (!notificationItem.IsValid()) {
+        return;
+    }
+
     if (reason == ENotificationReason::Error) {
 	    notificationItem->SetCompletionState(SNotificationItem::ECompletionState::CS_Fail);
-        UE_LOG(CodeGeneratorSub, Error, TEXT("%s"), *message);
     } else if (reason == ENotificationReason::Warning) {
 	    notificationItem->SetCompletionState(SNotificationItem::ECompletionState::CS_None);
-        UE_LOG(CodeGeneratorSub, Warning, TEXT("%s"), *message);
     } else if (reason == ENotificationReason::Success) {
 	    notificationItem->SetCompletionState(SNotificationItem::ECompletionState::CS_Success);
-        UE_LOG(CodeGeneratorSub, Display, TEXT("%s"), *message);
     }
 	notificationItem->ExpireAndFadeout();
 }
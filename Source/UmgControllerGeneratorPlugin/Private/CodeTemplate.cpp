@@ -0,0 +1,102 @@
+#include "CodeTemplate.h"
+#include "Misc/FileHelper.h"
+#include "HAL/FileManager.h"
+
+void FCodeTemplate::Compile(FString source, TConstArrayView<FString> placeholders) {
+    _source = MoveTemp(source);
+    _segments.Reset();
+    _literalLength = 0;
+    _filePath.Empty();
+    _fileTimestamp = FDateTime::MinValue();
+
+    // The first character of each placeholder so most characters can be skipped right away
+    TArray<TCHAR, TInlineAllocator<4>> firstCharacters;
+    for (const FString& placeholder : placeholders) {
+        if (!placeholder.IsEmpty()) {
+            firstCharacters.AddUnique(placeholder[0]);
+        }
+    }
+
+    FStringView text = _source;
+    int32 literalStart = 0;
+    int32 index = 0;
+    while (index < text.Len()) {
+        int32 matchedSlot = INDEX_NONE;
+        if (firstCharacters.Contains(text[index])) {
+            FStringView remaining = text.RightChop(index);
+            for (int32 slot = 0; slot < placeholders.Num(); slot++) {
+                if (!placeholders[slot].IsEmpty() && remaining.StartsWith(placeholders[slot], ESearchCase::CaseSensitive)) {
+                    matchedSlot = slot;
+                    break;
+                }
+            }
+        }
+
+        if (matchedSlot == INDEX_NONE) {
+            index++;
+            continue;
+        }
+
+        // Close off the text before the placeholder
+        if (index > literalStart) {
+            _segments.Add({ literalStart, index - literalStart, INDEX_NONE });
+            _literalLength += index - literalStart;
+        }
+
+        _segments.Add({ index, placeholders[matchedSlot].Len(), matchedSlot });
+        index += placeholders[matchedSlot].Len();
+        literalStart = index;
+    }
+
+    if (text.Len() > literalStart) {
+        _segments.Add({ literalStart, text.Len() - literalStart, INDEX_NONE });
+        _literalLength += text.Len() - literalStart;
+    }
+}
+
+bool FCodeTemplate::CompileFile(const FString& filePath, TConstArrayView<FString> placeholders) {
+    FString source;
+    if (!FFileHelper::LoadFileToString(source, *filePath)) {
+        return false;
+    }
+
+    Compile(MoveTemp(source), placeholders);
+    _filePath = filePath;
+    _fileTimestamp = IFileManager::Get().GetTimeStamp(*filePath);
+    return true;
+}
+
+bool FCodeTemplate::IsFileChanged() const {
+    if (_filePath.IsEmpty()) {
+        return false;
+    }
+
+    return IFileManager::Get().GetTimeStamp(*_filePath) != _fileTimestamp;
+}
+
+bool FCodeTemplate::HasPlaceholder(int32 slot) const {
+    return _segments.ContainsByPredicate([slot] (const FSegment& segment) {
+        return segment.Slot == slot;
+    });
+}
+
+FString FCodeTemplate::Render(TConstArrayView<FStringView> values) const {
+    int32 length = _literalLength;
+    for (const FSegment& segment : _segments) {
+        if (segment.Slot != INDEX_NONE && values.IsValidIndex(segment.Slot)) {
+            length += values[segment.Slot].Len();
+        }
+    }
+
+    FString result;
+    result.Reserve(length);
+    for (const FSegment& segment : _segments) {
+        if (segment.Slot == INDEX_NONE) {
+            result.Append(*_source + segment.Start, segment.Length);
+        } else if (values.IsValidIndex(segment.Slot)) {
+            result.Append(values[segment.Slot].GetData(), values[segment.Slot].Len());
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * A source file template that has been split into literal text and placeholders
+ * so it can be filled in with a single pass and one allocation.
+ *
+ * Placeholders are identified by their slot, which is their index in the list
+ * of placeholder names the template was compiled with. Anything in the template
+ * that isn't one of those names is literal text.
+ */
+class FCodeTemplate {
+public:
+    /**
+     * Compiles the given template text.
+     * @param placeholders The text of each placeholder, including any brackets. Ex: "[WIDGET_NAME]"
+     */
+    void Compile(FString source, TConstArrayView<FString> placeholders);
+
+    /**
+     * Loads the template from a file and compiles it. The file's timestamp is
+     * remembered so IsFileChanged can tell when it needs to be compiled again.
+     * @return Returns false if the file could not be loaded.
+     */
+    bool CompileFile(const FString& filePath, TConstArrayView<FString> placeholders);
+
+    /**
+     * Returns true if the template was compiled from a file that has changed since.
+     */
+    bool IsFileChanged() const;
+
+    /**
+     * Returns true if the template has the placeholder with the given slot anywhere in it.
+     */
+    bool HasPlaceholder(int32 slot) const;
+
+    /**
+     * Returns the template with each placeholder replaced with the value for its slot.
+     */
+    FString Render(TConstArrayView<FStringView> values) const;
+
+    const FString& GetFilePath() const { return _filePath; }
+
+private:
+    // A literal span of _source when Slot is INDEX_NONE, otherwise a placeholder
+    struct FSegment {
+        int32 Start = 0;
+        int32 Length = 0;
+        int32 Slot = INDEX_NONE;
+    };
+
+    FString _source;
+    TArray<FSegment> _segments;
+
+    // The length of all the literal text together, so the
+    // size of a rendered file is known before it's built
+    int32 _literalLength = 0;
+
+    // Set when the template came from a file
+    FString _filePath;
+    FDateTime _fileTimestamp;
+};
@@ -0,0 +1,186 @@
+#include "ControllerGenerationJob.h"
+#include "SectionSplicer.h"
+#include "SourceFile.h"
+#include "String/Find.h"
+
+DEFINE_LOG_CATEGORY_STATIC(ControllerGenerationSub, Log, All)
+
+const FString BindWidgetLabel = TEXT("UPROPERTY(BlueprintReadOnly, meta = (BindWidget))");
+const FString WidgetLineMarker = TEXT("static const inline FString WidgetPath = ");
+
+FControllerGenerationResult FControllerGenerationJob::Run() const {
+    FControllerGenerationResult result;
+
+    // Load each file from disk unless it's new, and replace the areas between the markers with the new data.
+    // New files use the line breaks from the templates.
+    FSourceFile headerFile;
+    if (!NewHeaderContents.IsEmpty()) {
+        headerFile.SetContents(NewHeaderContents);
+    } else if (!headerFile.Load(HeaderPath)) {
+        result.ErrorMessage = FString::Printf(TEXT("Failed to load the header file at %s"), *HeaderPath);
+        return result;
+    }
+
+    FString updatedHeaderFileContents = UpdateHeaderFile(headerFile.Contents);
+    if (updatedHeaderFileContents.IsEmpty()) {
+        result.ErrorMessage = FString::Printf(TEXT("Failed to update the header file at %s"), *HeaderPath);
+        return result;
+    }
+
+    FSourceFile cppFile;
+    if (!NewCppContents.IsEmpty()) {
+        cppFile.SetContents(NewCppContents);
+    } else if (!cppFile.Load(CppPath)) {
+        result.ErrorMessage = FString::Printf(TEXT("Failed to load the cpp file at %s"), *CppPath);
+        return result;
+    }
+
+    FString updatedCppFileContents = UpdateCppFile(cppFile.Contents);
+    if (updatedCppFileContents.IsEmpty()) {
+        result.ErrorMessage = FString::Printf(TEXT("Failed to update the cpp file at %s"), *CppPath);
+        return result;
+    }
+
+    headerFile.Contents = MoveTemp(updatedHeaderFileContents);
+    cppFile.Contents = MoveTemp(updatedCppFileContents);
+    if (VerifyOnly) {
+        result.WereFilesWritten = !headerFile.IsSavedAt(HeaderPath) || !cppFile.IsSavedAt(CppPath);
+        return result;
+    }
+
+    // Write both to a file. Files that didn't change are left alone so they don't get rebuilt.
+    bool wasHeaderWritten = false;
+    if (!headerFile.Save(HeaderPath, wasHeaderWritten)) {
+        result.ErrorMessage = FString::Printf(TEXT("Failed to save the header file to %s"), *HeaderPath);
+        return result;
+    }
+    bool wasCppWritten = false;
+    if (!cppFile.Save(CppPath, wasCppWritten)) {
+        result.ErrorMessage = FString::Printf(TEXT("Failed to save the cpp file to %s"), *CppPath);
+        return result;
+    }
+
+    result.WereFilesWritten = wasHeaderWritten || wasCppWritten;
+    return result;
+}
+
+FString FControllerGenerationJob::UpdateHeaderFile(const FString& headerContents) const {
+    // Find the different sections of the file
+    FSectionLayout layout;
+    FString error;
+    if (!HeaderSections->FindSections(headerContents, layout, error)) {
+        UE_LOG(ControllerGenerationSub, Error, TEXT("The generated sections in the header are malformed: %s"), *error);
+        return FString();
+    }
+
+    if (!layout.HasSection(PropertiesSectionId)) {
+        UE_LOG(ControllerGenerationSub, Error, TEXT("No properties section found in header"));
+        return FString();
+    }
+
+    if (!layout.HasSection(LoaderSectionId)) {
+        // Just write whatever was there before and don't update the loading section.
+        UE_LOG(ControllerGenerationSub, Error, TEXT("No loader section start found in header"));
+    }
+
+    // Roughly how much each property adds to the file
+    const int32 propertyLength = 96;
+
+    FString result;
+    HeaderSections->Splice(layout, result, Snapshot->Widgets.Num() * propertyLength, [this] (int32 sectionId, FStringView body, FString& output) {
+        if (sectionId == PropertiesSectionId) {
+            output.Append(TEXT("\n"));
+
+            // For each named widget, add it to the properties section
+            bool isFirst = true;
+            for (const FWidgetSnapshot& widget : Snapshot->Widgets) {
+                if (!isFirst)
+                    output.Append(TEXT("\n"));
+                output.Append(TEXT("    "));
+                output.Append(BindWidgetLabel);
+                output.Append(TEXT("\n    class U"));
+                output.Append(widget.NativeClassName);
+                output.Append(TEXT("* "));
+                output.Append(widget.Name);
+                output.Append(TEXT(" = nullptr;\n"));
+
+                isFirst = false;
+            }
+        } else if (sectionId == LoaderSectionId) {
+            // Rebuild the loader section with the current blueprint path
+            if (!AppendWithWidgetPath(body, Snapshot->BlueprintPath, output)) {
+                UE_LOG(ControllerGenerationSub, Error, TEXT("No widget path found in the loader section of the header"));
+                output.Append(body.GetData(), body.Len());
+            }
+        } else {
+            output.Append(body.GetData(), body.Len());
+        }
+    });
+
+    return result;
+}
+
+FString FControllerGenerationJob::UpdateCppFile(const FString& cppContents) const {
+    // Find the different sections of the file
+    FSectionLayout layout;
+    FString error;
+    if (!CppSections->FindSections(cppContents, layout, error)) {
+        UE_LOG(ControllerGenerationSub, Error, TEXT("The generated sections in the cpp are malformed: %s"), *error);
+        return FString();
+    }
+
+    if (!layout.HasSection(IncludesSectionId)) {
+        UE_LOG(ControllerGenerationSub, Error, TEXT("No includes section found in cpp"));
+        return FString();
+    }
+
+    TArray<FString> includes = Snapshot->GetIncludePaths();
+
+    // Each include is written as #include "path" on its own line
+    int32 includesLength = 0;
+    for (const FString& includePath : includes) {
+        includesLength += includePath.Len() + 12;
+    }
+
+    FString result;
+    CppSections->Splice(layout, result, includesLength, [&includes] (int32 sectionId, FStringView body, FString& output) {
+        if (sectionId == IncludesSectionId) {
+            output.Append(TEXT("\n"));
+            for (const FString& includePath : includes) {
+                output.Append(TEXT("#include \""));
+                output.Append(includePath);
+                output.Append(TEXT("\"\n"));
+            }
+        } else {
+            output.Append(body.GetData(), body.Len());
+        }
+    });
+
+    return result;
+}
+
+bool FControllerGenerationJob::AppendWithWidgetPath(FStringView contents, const FString& widgetPath, FString& output) {
+    int32 widgetLineStartIndex = UE::String::FindFirst(contents, WidgetLineMarker, ESearchCase::CaseSensitive);
+    if (widgetLineStartIndex == INDEX_NONE) {
+        return false;
+    }
+
+    int32 endOfLineIndex = INDEX_NONE;
+    if (contents.RightChop(widgetLineStartIndex).FindChar(TEXT('\n'), endOfLineIndex)) {
+        endOfLineIndex += widgetLineStartIndex;
+        if (contents[endOfLineIndex - 1] == TEXT('\r')) {
+            endOfLineIndex--;
+        }
+    } else {
+        endOfLineIndex = contents.Len();
+    }
+
+    output.Reserve(output.Len() + contents.Len() + widgetPath.Len());
+    output.Append(contents.GetData(), widgetLineStartIndex);
+    output.Append(WidgetLineMarker);
+    output.Append(TEXT("TEXT(\""));
+    output.Append(widgetPath);
+    output.Append(TEXT("\");"));
+    output.Append(contents.GetData() + endOfLineIndex, contents.Len() - endOfLineIndex);
+    return true;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WidgetTreeSnapshot.h"
+
+class FSectionSplicer;
+
+// Ids of the generated sections in the header and cpp section splicers
+const int32 PropertiesSectionId = 0;
+const int32 LoaderSectionId = 1;
+const int32 IncludesSectionId = 0;
+const int32 MethodsSectionId = 1;
+
+/**
+ * What happened when a job ran.
+ */
+struct FControllerGenerationResult {
+    // Empty if the job succeeded
+    FString ErrorMessage;
+
+    // False if both files already had the generated contents. When only
+    // verifying, this is whether they would have been written.
+    bool WereFilesWritten = false;
+
+    bool Succeeded() const { return ErrorMessage.IsEmpty(); }
+};
+
+/**
+ * How updating one controller in a batch turned out.
+ */
+enum class EControllerUpdateStatus : uint8 {
+    // The files were changed
+    Updated,
+
+    // The files already had the generated contents
+    UpToDate,
+
+    // Verifying found files that don't have the generated contents
+    OutOfDate,
+
+    Failed,
+
+    // The batch was cancelled before this one was written
+    Cancelled
+};
+
+inline const TCHAR* LexToString(EControllerUpdateStatus status) {
+    switch (status) {
+        case EControllerUpdateStatus::Updated: return TEXT("Updated");
+        case EControllerUpdateStatus::UpToDate: return TEXT("UpToDate");
+        case EControllerUpdateStatus::OutOfDate: return TEXT("OutOfDate");
+        case EControllerUpdateStatus::Failed: return TEXT("Failed");
+        default: return TEXT("Cancelled");
+    }
+}
+
+struct FControllerUpdateResult {
+    // The reference path of the blueprint. Ex: "/Game/UI/WBP_Menu.WBP_Menu"
+    FString BlueprintPath;
+
+    EControllerUpdateStatus Status = EControllerUpdateStatus::Cancelled;
+
+    // Why it failed if it did
+    FString Message;
+};
+
+/**
+ * How much memory one window of a batch update used.
+ */
+struct FControllerBatchWindow {
+    int32 BlueprintCount = 0;
+
+    // The most physical memory the process used while the window's blueprints were loaded
+    uint64 PeakUsedPhysical = 0;
+
+    // The physical memory the process used after collecting garbage at the end of the window
+    uint64 UsedPhysicalAfterCollect = 0;
+};
+
+/**
+ * Everything needed to generate and write a controller's files. It's filled in on the game
+ * thread so the files can be loaded, generated and saved on a worker.
+ */
+struct FControllerGenerationJob {
+    // The blueprint the controller is for
+    TSharedPtr<const FWidgetTreeSnapshot, ESPMode::ThreadSafe> Snapshot;
+
+    FString HeaderPath;
+    FString CppPath;
+
+    // The contents of new files rendered from the templates. When these are
+    // empty the existing files are loaded from HeaderPath and CppPath instead.
+    FString NewHeaderContents;
+    FString NewCppContents;
+
+    TSharedPtr<const FSectionSplicer, ESPMode::ThreadSafe> HeaderSections;
+    TSharedPtr<const FSectionSplicer, ESPMode::ThreadSafe> CppSections;
+
+    // Only check whether the files are up to date without writing them
+    bool VerifyOnly = false;
+
+    /**
+     * Generates both files and writes the ones that changed, or just compares them when verifying.
+     * Note: Doesn't touch any UObjects so it can be run on any thread.
+     */
+    FControllerGenerationResult Run() const;
+
+    /**
+     * Appends the given contents to output with the widget path line pointing at the given widget.
+     * The line ending of the widget path line is kept the way it was.
+     * @return Returns false if there is no widget path line in the contents.
+     */
+    static bool AppendWithWidgetPath(FStringView contents, const FString& widgetPath, FString& output);
+
+private:
+    FString UpdateHeaderFile(const FString& headerContents) const;
+    FString UpdateCppFile(const FString& cppContents) const;
+};
@@ -1,103 +1,1065 @@
 #include "HeaderLookupTable.h"
-#include "UhtManifestModel.h"
-#include <functional>
-#include "Misc/Paths.h" 	
+#include "UhtManifestReader.h"
+#include "Misc/Paths.h"
 #include "Misc/App.h"
 #include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
 #include "Misc/FileHelper.h"
-#include "JsonObjectConverter.h" 	
-#include "Misc/ConfigCacheIni.h"
+#include "Memory/MemoryView.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Hash/CityHash.h"
+#include "Async/ParallelFor.h"
+#include "DirectoryWatcherModule.h"
+#include "IDirectoryWatcher.h"
+#include "ILiveCodingModule.h"
+#include "Modules/ModuleManager.h"
+#include "Misc/PackageName.h"
 
 DEFINE_LOG_CATEGORY_STATIC(HeaderLookupTableSub, Log, All)
 #define STRINGIFY(x) #x
 #define TOSTRING(x) STRINGIFY(x)
 
-void UHeaderLookupTable::InitTable() {
+namespace {
+    /**
+     * Maps a file into memory if the platform supports it, otherwise reads it into a buffer.
+     */
+    class FReadOnlyFileView {
+    public:
+        bool Open(const FString& filePath) {
+            IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+            _mappedFile.Reset(platformFile.OpenMapped(*filePath));
+            if (_mappedFile.IsValid()) {
+                _mappedRegion.Reset(_mappedFile->MapRegion());
+            }
+
+            if (_mappedRegion.IsValid()) {
+                _view = MakeMemoryView(_mappedRegion->GetMappedPtr(), _mappedRegion->GetMappedSize());
+                return true;
+            }
+
+            if (!FFileHelper::LoadFileToArray(_buffer, *filePath)) {
+                return false;
+            }
+            _view = MakeMemoryView(_buffer);
+            return true;
+        }
+
+        FMemoryView GetView() const { return _view; }
+
+    private:
+        // Note: The region must be released before the handle so keep this declaration order.
+        TUniquePtr<IMappedFileHandle> _mappedFile;
+        TUniquePtr<IMappedFileRegion> _mappedRegion;
+        TArray<uint8> _buffer;
+        FMemoryView _view;
+    };
+
+    /**
+     * The work done for a single module while indexing the manifest in parallel.
+     */
+    struct FModuleIndexWork {
+        FName ModuleName;
+        uint64 Fingerprint = 0;
+        bool IsChanged = false;
+
+        // Class name to include path for each header in the module
+        TArray<TPair<FName, FString>> Entries;
+    };
+}
+
+bool UHeaderLookupTable::InitTable() {
+    FString uhtPath = GetManifestFilePath();
+    FFileStatData manifestStat = IFileManager::Get().GetStatData(*uhtPath);
+    if (!manifestStat.bIsValid) {
+        UE_LOG(HeaderLookupTableSub, Error, TEXT("Failed to find the UHT Manifest for header file lookup support at %s."), *uhtPath);
+        return false;
+    }
+
+    // Start from the cached index on the first build of the session. Even if it's
+    // out of date, it lets us re-index only the modules that changed.
+    double timeBefore = FPlatformTime::Seconds();
+    if (_moduleIndices.Num() == 0) {
+        LoadCache();
+    }
+
+    int64 previousTimestamp = _indexedManifestTimestamp;
+    if (IsIndexCurrent(uhtPath, manifestStat)) {
+        // Refresh the timestamp in the cache so the next session can skip hashing
+        if (previousTimestamp != _indexedManifestTimestamp) {
+            SaveCache();
+        }
+
+        _isIndexComplete = true;
+        _moduleLocations.Empty();
+        SetModulesVerified();
+        ShrinkTable();
+        PublishIndex();
+
+        double elapsedTimeMs = (FPlatformTime::Seconds() - timeBefore) * 1000.0;
+        UE_LOG(HeaderLookupTableSub, Display, TEXT("Header lookup table is up to date (checked in %f ms)"), elapsedTimeMs);
+        LogMemoryUsage();
+        return true;
+    }
+
+    // Map the file
+    FReadOnlyFileView manifestFile;
+    if (!manifestFile.Open(uhtPath)) {
+        UE_LOG(HeaderLookupTableSub, Error, TEXT("Failed to load the UHT Manifest for header file lookup support."));
+        return false;
+    }
+
+    // Hash the contents while we have them so the cache can be validated later
+    FMD5 md5;
+    md5.Update((const uint8*)manifestFile.GetView().GetData(), manifestFile.GetView().GetSize());
+    FMD5Hash manifestHash;
+    manifestHash.Set(md5);
+
+    if (!IndexManifest(manifestFile.GetView())) {
+        return false;
+    }
+
+    _indexedManifestPath = uhtPath;
+    _indexedManifestSize = manifestStat.FileSize;
+    _indexedManifestTimestamp = manifestStat.ModificationTime.GetTicks();
+    _indexedManifestHash = manifestHash;
+    _isIndexComplete = true;
+    _moduleLocations.Empty();
+    SetModulesVerified();
+    ShrinkTable();
+    PublishIndex();
+
+    double elapsedTimeMs = (FPlatformTime::Seconds() - timeBefore) * 1000.0;
+    UE_LOG(HeaderLookupTableSub, Display, TEXT("Initialized header lookup table in %f ms"), elapsedTimeMs);
+    LogMemoryUsage();
+
+    SaveCache();
+    return true;
+}
+
+void UHeaderLookupTable::BeginDestroy() {
+    StopWatching();
+    _snapshot.Reset();
+    _pendingIndex.Reset();
+
+    Super::BeginDestroy();
+}
+
+void UHeaderLookupTable::EnsureUpToDate() {
+    if (_isStale) {
+        // Clear the flag first so a change that arrives while we're building is not lost
+        _isStale = false;
+
+        // Anything that couldn't be found before may be there now
+        _unresolvedClasses.Empty();
+
+        // If the manifest couldn't be read, try again next time rather than trusting what we have
+        bool isBuilt = _isLazy ? InitLazyTable() : InitTable();
+        if (!isBuilt) {
+            _isStale = true;
+        }
+        PublishIndex();
+    }
+}
+
+void UHeaderLookupTable::BuildFullIndex() {
+    _isStale = false;
+    _unresolvedClasses.Empty();
+    if (!InitTable()) {
+        _isStale = true;
+    }
+    PublishIndex();
+}
+
+void UHeaderLookupTable::SetLazyIndexing(bool isLazy) {
+    if (_isLazy != isLazy) {
+        _isLazy = isLazy;
+        Invalidate();
+    }
+}
+
+/**
+ * Prepares the table for lazy indexing. If the cached index is current it's used
+ * as is, otherwise the manifest is only scanned for where each module is.
+ */
+bool UHeaderLookupTable::InitLazyTable() {
+    FString uhtPath = GetManifestFilePath();
+    FFileStatData manifestStat = IFileManager::Get().GetStatData(*uhtPath);
+    if (!manifestStat.bIsValid) {
+        UE_LOG(HeaderLookupTableSub, Error, TEXT("Failed to find the UHT Manifest for header file lookup support at %s."), *uhtPath);
+        return false;
+    }
+
+    // A complete index from a previous session is as good as it gets
+    double timeBefore = FPlatformTime::Seconds();
+    if (_moduleIndices.Num() == 0) {
+        LoadCache();
+    }
+
+    int64 previousTimestamp = _indexedManifestTimestamp;
+    if (IsIndexCurrent(uhtPath, manifestStat)) {
+        if (previousTimestamp != _indexedManifestTimestamp) {
+            SaveCache();
+        }
+        _isIndexComplete = true;
+        _moduleLocations.Empty();
+        SetModulesVerified();
+        ShrinkTable();
+        return true;
+    }
+
+    FReadOnlyFileView manifestFile;
+    if (!manifestFile.Open(uhtPath)) {
+        UE_LOG(HeaderLookupTableSub, Error, TEXT("Failed to load the UHT Manifest for header file lookup support."));
+        return false;
+    }
+
+    TArray<FUhtModuleLocation> locations;
+    if (!FUhtManifestReader::FindModules(manifestFile.GetView(), locations)) {
+        UE_LOG(HeaderLookupTableSub, Error, TEXT("The UHT Manifest file was not read properly. Could the file be corrupt?"));
+        return false;
+    }
+
+    // Modules we already know about have to be checked against the new manifest before they're used again
+    _isIndexComplete = false;
+    _verifiedModules.Empty();
+    _moduleLocations.Empty();
+    for (FUhtModuleLocation& location : locations) {
+        FName moduleName(*location.Name);
+        _moduleLocations.Add(moduleName, MoveTemp(location));
+    }
+
+    TArray<FName> removedModules;
+    for (TPair<FName, FHeaderModuleIndex>& entry : _moduleIndices) {
+        const FUhtModuleLocation* location = _moduleLocations.Find(entry.Key);
+        if (location != nullptr) {
+            entry.Value.Order = location->Order;
+        } else {
+            removedModules.Add(entry.Key);
+        }
+    }
+    for (FName moduleName : removedModules) {
+        RemoveModule(moduleName);
+    }
+
+    // What's left may be out of date so lookups can't use it until each module has been checked
+    FHeaderIndexData& index = GetWritableIndex();
+    index.UnverifiedModuleIds.Empty();
+    for (const TPair<FName, FHeaderModuleIndex>& entry : _moduleIndices) {
+        index.UnverifiedModuleIds.Add(index.AddModuleName(entry.Key));
+    }
+
+    double elapsedTimeMs = (FPlatformTime::Seconds() - timeBefore) * 1000.0;
+    UE_LOG(HeaderLookupTableSub, Display, TEXT("Found %d modules in the UHT manifest in %f ms. They will be indexed as they are needed."), _moduleLocations.Num(), elapsedTimeMs);
+    return true;
+}
+
+/**
+ * Makes sure the given module's headers are in the table. This only does
+ * something in lazy mode when the module hasn't been checked yet.
+ */
+void UHeaderLookupTable::IndexModuleOnDemand(FName moduleName) {
+    if (_isIndexComplete || _verifiedModules.Contains(moduleName)) {
+        return;
+    }
+    _verifiedModules.Add(moduleName);
+
+    const FUhtModuleLocation* location = _moduleLocations.Find(moduleName);
+    if (location == nullptr) {
+        // The module isn't part of this target
+        return;
+    }
+
+    FReadOnlyFileView manifestFile;
+    if (!manifestFile.Open(GetManifestFilePath())) {
+        UE_LOG(HeaderLookupTableSub, Error, TEXT("Failed to load the UHT Manifest for header file lookup support."));
+        return;
+    }
+
+    // If the manifest changed since it was scanned, the watcher will have invalidated
+    // us already but check anyway since we're about to read from an offset into it.
+    FMemoryView manifestBytes = manifestFile.GetView();
+    FUhtModuleHeaders moduleHeaders;
+    if (location->Offset + location->Size > (int64)manifestBytes.GetSize()
+            || !FUhtManifestReader::ReadModule(manifestBytes.Mid(location->Offset, location->Size), moduleHeaders)
+            || !moduleHeaders.Name.Equals(location->Name)) {
+        UE_LOG(HeaderLookupTableSub, Warning, TEXT("The UHT Manifest changed while indexing module %s. It will be rescanned."), *moduleName.ToString());
+        Invalidate();
+        return;
+    }
+
+    uint64 fingerprint = ComputeModuleFingerprint(moduleHeaders);
+    const FHeaderModuleIndex* existingIndex = _moduleIndices.Find(moduleName);
+    if (existingIndex == nullptr || existingIndex->Fingerprint != fingerprint) {
+        TArray<TPair<FName, FString>> entries;
+        BuildModuleEntries(moduleHeaders, entries);
+        RemoveModule(moduleName);
+        IndexModule(moduleName, location->Order, fingerprint, entries);
+        UE_LOG(HeaderLookupTableSub, Verbose, TEXT("Indexed %d headers for module %s"), entries.Num(), *moduleName.ToString());
+    }
+
+    // Its entries match the manifest now so lookups can use them
+    const uint16* moduleId = GetCurrentIndex().ModuleIds.Find(moduleName);
+    if (moduleId != nullptr && GetCurrentIndex().UnverifiedModuleIds.Contains(*moduleId)) {
+        GetWritableIndex().UnverifiedModuleIds.Remove(*moduleId);
+    }
+}
+
+/**
+ * Lets lookups use every module's entries once the whole index matches the manifest.
+ */
+void UHeaderLookupTable::SetModulesVerified() {
+    if (GetCurrentIndex().UnverifiedModuleIds.Num() > 0) {
+        GetWritableIndex().UnverifiedModuleIds.Empty();
+    }
+}
+
+void UHeaderLookupTable::StartWatching() {
+    if (_isWatching) {
+        return;
+    }
+    _isWatching = true;
+
+    // UBT rewrites the manifest whenever the target is built so watch its directory
+    FDirectoryWatcherModule& directoryWatcherModule = FModuleManager::LoadModuleChecked<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+    IDirectoryWatcher* directoryWatcher = directoryWatcherModule.Get();
+    if (directoryWatcher != nullptr) {
+        _watchedManifestDirectory = FPaths::GetPath(GetManifestFilePath());
+        directoryWatcher->RegisterDirectoryChangedCallback_Handle(
+            _watchedManifestDirectory,
+            IDirectoryWatcher::FDirectoryChanged::CreateUObject(this, &UHeaderLookupTable::OnManifestDirectoryChanged),
+            _manifestWatcherHandle);
+    }
+
+    ILiveCodingModule* liveCoding = FModuleManager::GetModulePtr<ILiveCodingModule>(LIVE_CODING_MODULE_NAME);
+    if (liveCoding != nullptr) {
+        _liveCodingHandle = liveCoding->GetOnPatchCompleteDelegate().AddUObject(this, &UHeaderLookupTable::OnLiveCodingPatchComplete);
+    }
+
+    _reloadCompleteHandle = FCoreUObjectDelegates::ReloadCompleteDelegate.AddUObject(this, &UHeaderLookupTable::OnReloadComplete);
+}
+
+void UHeaderLookupTable::StopWatching() {
+    if (!_isWatching) {
+        return;
+    }
+    _isWatching = false;
+
+    FDirectoryWatcherModule* directoryWatcherModule = FModuleManager::GetModulePtr<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+    if (directoryWatcherModule != nullptr && directoryWatcherModule->Get() != nullptr && _manifestWatcherHandle.IsValid()) {
+        directoryWatcherModule->Get()->UnregisterDirectoryChangedCallback_Handle(_watchedManifestDirectory, _manifestWatcherHandle);
+    }
+    _manifestWatcherHandle.Reset();
+
+    ILiveCodingModule* liveCoding = FModuleManager::GetModulePtr<ILiveCodingModule>(LIVE_CODING_MODULE_NAME);
+    if (liveCoding != nullptr) {
+        liveCoding->GetOnPatchCompleteDelegate().Remove(_liveCodingHandle);
+    }
+    _liveCodingHandle.Reset();
+
+    FCoreUObjectDelegates::ReloadCompleteDelegate.Remove(_reloadCompleteHandle);
+    _reloadCompleteHandle.Reset();
+}
+
+FString UHeaderLookupTable::GetIncludeFilePathFor(FString className) {
+    EnsureUpToDate();
+
+    // If there's no name for it, nothing has a header with that name
+    FName classFName(*className, FNAME_Find);
+    if (classFName.IsNone()) {
+        return FString();
+    }
+    return GetCurrentIndex().FindIncludePath(classFName, NAME_None);
+}
+
+FString UHeaderLookupTable::GetIncludeFilePathFor(UClass* nativeClass) {
+    if (nativeClass == nullptr) {
+        return FString();
+    }
+
+    FObjectKey classKey(nativeClass);
+    if (const FString* cachedPath = _classIncludePaths.Find(classKey)) {
+        return *cachedPath;
+    }
+
+    // Only fall back to the manifest if the class doesn't know where it's declared
+    FString includePath = GetIncludePathFromMetadata(nativeClass);
+    if (includePath.IsEmpty()) {
+        EnsureUpToDate();
+        if (_unresolvedClasses.Contains(classKey)) {
+            return FString();
+        }
+
+        // Only the module the class is in needs to be indexed to find it. The module is added
+        // to the pending copy of the index and read from there rather than published so each
+        // miss doesn't copy the whole index. It's published along with the next rebuild.
+        FName moduleName = GetModuleNameForClass(nativeClass);
+        IndexModuleOnDemand(moduleName);
+        includePath = GetCurrentIndex().FindIncludePath(nativeClass->GetFName(), moduleName);
+    }
+
+    // Misses are remembered until the table is invalidated
+    if (!includePath.IsEmpty()) {
+        _classIncludePaths.Add(classKey, includePath);
+    } else {
+        _unresolvedClasses.Add(classKey);
+    }
+    return includePath;
+}
+
+/**
+ * Returns the copy of the index that changes should be made to. The
+ * first change after a publish starts from a copy of the published one
+ * so changes should be batched into as few publishes as possible.
+ */
+FHeaderIndexData& UHeaderLookupTable::GetWritableIndex() {
+    if (!_pendingIndex.IsValid()) {
+        _pendingIndex = _snapshot.IsValid() ? MakeUnique<FHeaderIndexData>(*_snapshot) : MakeUnique<FHeaderIndexData>();
+    }
+    return *_pendingIndex;
+}
+
+/**
+ * Returns the latest version of the index, whether it's been published or not.
+ */
+const FHeaderIndexData& UHeaderLookupTable::GetCurrentIndex() const {
+    if (_pendingIndex.IsValid()) {
+        return *_pendingIndex;
+    }
+
+    static const FHeaderIndexData EmptyIndex;
+    return _snapshot.IsValid() ? *_snapshot : EmptyIndex;
+}
+
+/**
+ * Replaces the published index with the pending changes.
+ */
+void UHeaderLookupTable::PublishIndex() {
+    if (_pendingIndex.IsValid()) {
+        _snapshot = MoveTemp(_pendingIndex);
+    }
+}
+
+FString FHeaderIndexData::FindIncludePath(FName className, FName preferredModule) const {
+    const FHeaderCandidates* candidates = LookupTable.Find(className);
+    if (candidates == nullptr || candidates->Num() == 0) {
+        return FString();
+    }
+
+    const uint16* preferredModuleId = ModuleIds.Find(preferredModule);
+    if (preferredModuleId != nullptr) {
+        const FHeaderLookupEntry* entry = candidates->FindByPredicate([preferredModuleId] (const FHeaderLookupEntry& candidate) { return candidate.ModuleId == *preferredModuleId; });
+        if (entry != nullptr && IsVerified(*entry)) {
+            return BuildIncludePath(className, *entry);
+        }
+    }
+
+    // Otherwise the first module in the manifest wins, as long as its entry is known to be current
+    const FHeaderLookupEntry* entry = candidates->FindByPredicate([this] (const FHeaderLookupEntry& candidate) { return IsVerified(candidate); });
+    return entry != nullptr ? BuildIncludePath(className, *entry) : FString();
+}
+
+/**
+ * Puts the include path for an entry back together.
+ */
+FString FHeaderIndexData::BuildIncludePath(FName className, const FHeaderLookupEntry& entry) const {
+    FStringView directory = DirectoryPool.Get(entry.DirectoryId);
+    const FString& extension = Extensions[entry.ExtensionId];
+
+    FString includePath;
+    includePath.Reserve(directory.Len() + className.GetStringLength() + extension.Len());
+    includePath.Append(directory.GetData(), directory.Len());
+    if (entry.FileNameId != INDEX_NONE) {
+        FStringView fileName = FileNamePool.Get(entry.FileNameId);
+        includePath.Append(fileName.GetData(), fileName.Len());
+    } else {
+        className.AppendString(includePath);
+    }
+    includePath.Append(extension);
+    return includePath;
+}
+
+FHeaderLookupEntry FHeaderIndexData::MakeEntry(FName className, FStringView includePath, FName moduleName) {
+    // Split the path into the directory, which is pooled, and the extension.
+    // The part in between is usually the class name so it doesn't need to be stored.
+    int32 slashIndex = INDEX_NONE;
+    includePath.FindLastChar(TEXT('/'), slashIndex);
+    FStringView directory = includePath.Left(slashIndex + 1);
+    FStringView fileName = includePath.RightChop(slashIndex + 1);
+
+    int32 dotIndex = INDEX_NONE;
+    FStringView extension = fileName.FindLastChar(TEXT('.'), dotIndex) ? fileName.RightChop(dotIndex) : FStringView();
+    FStringView baseName = fileName.LeftChop(extension.Len());
+
+    FHeaderLookupEntry entry;
+    entry.DirectoryId = DirectoryPool.Add(directory);
+    entry.ModuleId = AddModuleName(moduleName);
+    entry.ExtensionId = AddExtension(extension);
+
+    // The name keeps the casing it was first created with which may not be the file's.
+    // Includes are case sensitive on some platforms so keep the file's when they differ.
+    TCHAR classNameBuffer[NAME_SIZE];
+    uint32 classNameLength = className.ToString(classNameBuffer);
+    if (!baseName.Equals(FStringView(classNameBuffer, classNameLength), ESearchCase::CaseSensitive)) {
+        entry.FileNameId = FileNamePool.Add(baseName);
+    }
+    return entry;
+}
+
+uint16 FHeaderIndexData::AddModuleName(FName moduleName) {
+    if (const uint16* moduleId = ModuleIds.Find(moduleName)) {
+        return *moduleId;
+    }
+
+    // There are a few hundred modules in a typical target so this is plenty
+    check(ModuleNames.Num() < MAX_uint16);
+    uint16 moduleId = (uint16)ModuleNames.Add(moduleName);
+    ModuleIds.Add(moduleName, moduleId);
+    return moduleId;
+}
+
+uint16 FHeaderIndexData::AddExtension(FStringView extension) {
+    for (int32 i = 0; i < Extensions.Num(); i++) {
+        if (extension.Equals(Extensions[i], ESearchCase::CaseSensitive)) {
+            return (uint16)i;
+        }
+    }
+    return (uint16)Extensions.Emplace(extension);
+}
+
+SIZE_T FHeaderIndexData::GetAllocatedSize() const {
+    SIZE_T size = LookupTable.GetAllocatedSize();
+    for (const TPair<FName, FHeaderCandidates>& entry : LookupTable) {
+        // Only lists with more than one candidate allocate
+        size += entry.Value.GetAllocatedSize();
+    }
+    size += DirectoryPool.GetAllocatedSize() + FileNamePool.GetAllocatedSize() + Extensions.GetAllocatedSize();
+    size += ModuleNames.GetAllocatedSize() + ModuleIds.GetAllocatedSize();
+    size += UnverifiedModuleIds.GetAllocatedSize();
+    return size;
+}
+
+SIZE_T UHeaderLookupTable::GetAllocatedSize() const {
+    SIZE_T size = _moduleIndices.GetAllocatedSize();
+    for (const TPair<FName, FHeaderModuleIndex>& entry : _moduleIndices) {
+        size += entry.Value.ClassNames.GetAllocatedSize();
+    }
+
+    // Count both copies of the index while there are unpublished changes
+    if (_snapshot.IsValid()) {
+        size += _snapshot->GetAllocatedSize();
+    }
+    if (_pendingIndex.IsValid()) {
+        size += _pendingIndex->GetAllocatedSize();
+    }
+    return size;
+}
+
+/**
+ * Logs how much memory the table uses. The HeaderLookupTable.MemoryUsage automation test
+ * compares it with a map of class name strings to include path strings.
+ */
+void UHeaderLookupTable::LogMemoryUsage() const {
+    const FHeaderIndexData& index = GetCurrentIndex();
+    UE_LOG(HeaderLookupTableSub, Display, TEXT("Header lookup table uses %.1f KB for %d classes in %d directories"),
+        GetAllocatedSize() / 1024.0, index.LookupTable.Num(), index.DirectoryPool.Num());
+}
+
+bool UHeaderLookupTable::AbbreviateHeaderPath(const FString& headerPath, const FString& moduleBasePath, FString& outIncludePath) {
+    // The manifest is written with the host's separators so normalize
+    // everything to forward slashes before comparing anything.
+    FString normalizedHeaderPath = headerPath;
+    FPaths::NormalizeFilename(normalizedHeaderPath);
+    FString normalizedBasePath = moduleBasePath;
+    FPaths::NormalizeFilename(normalizedBasePath);
+
+    if (!normalizedHeaderPath.StartsWith(normalizedBasePath)) {
+        return false;
+    }
+
+    FString abbreviatedHeaderPath = normalizedHeaderPath.RightChop(normalizedBasePath.Len());
+
+    // If it starts with a slash, remove it
+    if (abbreviatedHeaderPath.StartsWith(TEXT("/"))) {
+        abbreviatedHeaderPath = abbreviatedHeaderPath.RightChop(1);
+    }
+
+    // If it's in a public folder, omit the public part
+    const FString publicPrefix = TEXT("Public/");
+    if (abbreviatedHeaderPath.StartsWith(publicPrefix)) {
+        abbreviatedHeaderPath = abbreviatedHeaderPath.RightChop(publicPrefix.Len());
+    }
+
+    // If it's in a private folder, omit the private part
+    const FString privatePrefix = TEXT("Private/");
+    if (abbreviatedHeaderPath.StartsWith(privatePrefix)) {
+        abbreviatedHeaderPath = abbreviatedHeaderPath.RightChop(privatePrefix.Len());
+    }
+
+    outIncludePath = abbreviatedHeaderPath;
+    return true;
+}
+
+/**
+ * @return Returns the path to the UHT manifest of the target this editor was built for.
+ */
+FString UHeaderLookupTable::GetManifestFilePath() {
     // Get all the various info we need to find the UHT manifest
     FString platform = TEXT(TOSTRING(UBT_COMPILED_PLATFORM));
     FString target = TEXT(TOSTRING(UE_TARGET_NAME));
-    FString ubtTarget = TEXT(TOSTRING(UBT_COMPILED_TARGET));
     FString intermediateDir = FPaths::ProjectIntermediateDir();
     EBuildConfiguration buildConfig = FApp::GetBuildConfiguration();
     FString buildConfigStr = LexToString(buildConfig);
 
     // Build the UHT manifest file path
     FString uhtManifestFileName = target + TEXT(".uhtmanifest");
-    FString uhtPath = FPaths::Combine(intermediateDir, TEXT("Build"), platform, target, buildConfigStr, uhtManifestFileName);
+    return FPaths::Combine(intermediateDir, TEXT("Build"), platform, target, buildConfigStr, uhtManifestFileName);
+}
 
-    // Load the file
-    FString uhtManifestContents;
-    if (!FFileHelper::LoadFileToString(uhtManifestContents, *uhtPath)) {
-        UE_LOG(HeaderLookupTableSub, Error, TEXT("Failed to load the UHT Manifest for header file lookup support."));
-        return;
+/**
+ * @return Returns the path to the binary header index cache for the current target.
+ */
+FString UHeaderLookupTable::GetCacheFilePath() {
+    FString target = TEXT(TOSTRING(UE_TARGET_NAME));
+    return FPaths::Combine(FPaths::ProjectIntermediateDir(), TEXT("UmgControllerGenerator"), target + TEXT(".headerindex"));
+}
+
+/**
+ * Returns true if the table was built from the manifest as it is on disk now.
+ */
+bool UHeaderLookupTable::IsIndexCurrent(const FString& manifestPath, const FFileStatData& manifestStat) {
+    if (!_indexedManifestPath.Equals(manifestPath) || _indexedManifestSize != manifestStat.FileSize) {
+        return false;
     }
 
-    // Parse into JSON
-    FUhtManifestModel manifestModel;
-	if (!FJsonObjectConverter::JsonObjectStringToUStruct(uhtManifestContents, &manifestModel, 0, 0)) {
-        UE_LOG(HeaderLookupTableSub, Error, TEXT("The UHT Manifest file was not deserialized from JSON properly. Could the file be corrupt?"));
-        return;
+    int64 manifestTimestamp = manifestStat.ModificationTime.GetTicks();
+    if (_indexedManifestTimestamp == manifestTimestamp) {
+        return true;
     }
 
-    // Build the table from the includes available in the dependent modules
-    _lookupTable.Empty();
-    double timeBefore = FPlatformTime::Seconds();
-    for (const FUhtModuleModel& moduleModel : manifestModel.Modules) {
-        // Function to use to add each type of header array
-        std::function addHeaders = [this, &moduleModel] (const TArray<FString>& headerArray) {
-            FString moduleBasePath = moduleModel.BaseDirectory;
-            for (const FString& headerPath : headerArray) {
-                // Use the header name as the file name that maps to it.
-                // This is an assumption but will work ~100% of the time.
-                FString className = FPaths::GetBaseFilename(headerPath);
-
-                if (headerPath.StartsWith(moduleBasePath)) {
-                    FString abbreviatedHeaderPath = headerPath.RightChop(moduleBasePath.Len());
-
-                    // If it starts with a slash, remove it
-                    const FString backslash = TEXT("\\");
-                    if (abbreviatedHeaderPath.StartsWith(TEXT("\\"))) {
-                        abbreviatedHeaderPath = abbreviatedHeaderPath.RightChop(backslash.Len());
-                    }
-
-                    // If it's in a public folder, omit the public part
-                    const FString publicPrefix = TEXT("Public\\");
-                    if (abbreviatedHeaderPath.StartsWith(publicPrefix)) {
-                        abbreviatedHeaderPath = abbreviatedHeaderPath.RightChop(publicPrefix.Len());
-                    }
-
-                    // If it's in a private folder, omit the private part
-                    const FString privatePrefix = TEXT("Private\\");
-                    if (abbreviatedHeaderPath.StartsWith(privatePrefix)) {
-                        abbreviatedHeaderPath = abbreviatedHeaderPath.RightChop(privatePrefix.Len());
-                    }
-
-                    // Replace all backslashes with forward slashes
-                    const FString forwardSlash = TEXT("/");
-                    abbreviatedHeaderPath = abbreviatedHeaderPath.Replace(*backslash, *forwardSlash);
-
-                    if (!_lookupTable.Contains(className)) {
-                        _lookupTable.Add(className, abbreviatedHeaderPath);
-                    } else {
-                        UE_LOG(HeaderLookupTableSub, Warning, TEXT("Header file %s was already added for module %s"), *abbreviatedHeaderPath, *moduleModel.Name);    
-                    }
+    // The manifest is rewritten on every build even when nothing changed so if the
+    // timestamp differs, fall back to comparing the contents before giving up.
+    if (FMD5Hash::HashFile(*manifestPath) == _indexedManifestHash) {
+        _indexedManifestTimestamp = manifestTimestamp;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Updates the table from the contents of the UHT manifest. Only the modules
+ * whose fingerprint changed since the last time are re-indexed.
+ * @return Returns false if the manifest could not be parsed.
+ */
+bool UHeaderLookupTable::IndexManifest(FMemoryView manifestBytes) {
+    TArray<FUhtModuleHeaders> modules;
+    if (!FUhtManifestReader::ReadModules(manifestBytes, modules)) {
+        UE_LOG(HeaderLookupTableSub, Error, TEXT("The UHT Manifest file was not read properly. Could the file be corrupt?"));
+        return false;
+    }
+
+    // Work out which modules changed and build their entries in parallel. Nothing
+    // is written to the table until this is done so reading _moduleIndices is safe.
+    TArray<FModuleIndexWork> moduleWork;
+    moduleWork.SetNum(modules.Num());
+    ParallelFor(modules.Num(), [this, &modules, &moduleWork] (int32 order) {
+        const FUhtModuleHeaders& moduleHeaders = modules[order];
+        FModuleIndexWork& work = moduleWork[order];
+        work.ModuleName = FName(*moduleHeaders.Name);
+        work.Fingerprint = ComputeModuleFingerprint(moduleHeaders);
+
+        const FHeaderModuleIndex* existingIndex = _moduleIndices.Find(work.ModuleName);
+        work.IsChanged = existingIndex == nullptr || existingIndex->Fingerprint != work.Fingerprint;
+        if (work.IsChanged) {
+            BuildModuleEntries(moduleHeaders, work.Entries);
+        }
+    });
+
+    // Splice in the modules that changed
+    TSet<FName> manifestModules;
+    int32 reindexedCount = 0;
+    for (int32 order = 0; order < moduleWork.Num(); order++) {
+        FModuleIndexWork& work = moduleWork[order];
+        manifestModules.Add(work.ModuleName);
+
+        if (!work.IsChanged) {
+            // Nothing changed so keep its entries. The order only matters for
+            // precedence between modules so just keep track of where it is now.
+            _moduleIndices[work.ModuleName].Order = order;
+            continue;
+        }
+
+        RemoveModule(work.ModuleName);
+        IndexModule(work.ModuleName, order, work.Fingerprint, work.Entries);
+        reindexedCount++;
+    }
+
+    // Remove anything for modules that are no longer in the manifest
+    TArray<FName> removedModules;
+    for (const TPair<FName, FHeaderModuleIndex>& entry : _moduleIndices) {
+        if (!manifestModules.Contains(entry.Key)) {
+            removedModules.Add(entry.Key);
+        }
+    }
+    for (FName moduleName : removedModules) {
+        RemoveModule(moduleName);
+    }
+
+    UE_LOG(HeaderLookupTableSub, Display, TEXT("Re-indexed %d of %d modules (%d removed)"), reindexedCount, modules.Num(), removedModules.Num());
+    return true;
+}
+
+/**
+ * Works out the include path for each header in a module. This doesn't touch
+ * the table so it can be called for several modules at once.
+ */
+void UHeaderLookupTable::BuildModuleEntries(const FUhtModuleHeaders& moduleHeaders, TArray<TPair<FName, FString>>& outEntries) {
+    // Function to use to add each type of header array
+    TSet<FName> addedClassNames;
+    auto addHeaders = [&moduleHeaders, &addedClassNames, &outEntries] (const TArray<FString>& headerArray) {
+        for (const FString& headerPath : headerArray) {
+            // Use the header name as the file name that maps to it.
+            // This is an assumption but will work ~100% of the time.
+            FName className(*FPaths::GetBaseFilename(headerPath));
+
+            FString abbreviatedHeaderPath;
+            if (AbbreviateHeaderPath(headerPath, moduleHeaders.BaseDirectory, abbreviatedHeaderPath)) {
+                if (!addedClassNames.Contains(className)) {
+                    addedClassNames.Add(className);
+                    outEntries.Emplace(className, MoveTemp(abbreviatedHeaderPath));
                 } else {
-                    UE_LOG(HeaderLookupTableSub, Warning, TEXT("Header file does not start with the base path at %s in module %s"), *headerPath, *moduleModel.Name);
+                    UE_LOG(HeaderLookupTableSub, Warning, TEXT("Header file %s was already added for module %s"), *abbreviatedHeaderPath, *moduleHeaders.Name);
                 }
+            } else {
+                UE_LOG(HeaderLookupTableSub, Warning, TEXT("Header file does not start with the base path at %s in module %s"), *headerPath, *moduleHeaders.Name);
             }
-        };
-        addHeaders(moduleModel.PrivateHeaders);
-        addHeaders(moduleModel.InternalHeaders);
-        addHeaders(moduleModel.PublicHeaders);
+        }
+    };
+    addHeaders(moduleHeaders.PrivateHeaders);
+    addHeaders(moduleHeaders.InternalHeaders);
+    addHeaders(moduleHeaders.PublicHeaders);
+}
+
+/**
+ * Adds the headers of a single module to the table.
+ */
+void UHeaderLookupTable::IndexModule(FName moduleName, int32 order, uint64 fingerprint, const TArray<TPair<FName, FString>>& entries) {
+    FHeaderModuleIndex& moduleIndex = _moduleIndices.Add(moduleName);
+    moduleIndex.Fingerprint = fingerprint;
+    moduleIndex.Order = order;
+    moduleIndex.ClassNames.Reserve(entries.Num());
+
+    for (const TPair<FName, FString>& entry : entries) {
+        moduleIndex.ClassNames.Add(entry.Key);
+        AddEntry(entry.Key, entry.Value, moduleName, order);
     }
-    double timeAfter = FPlatformTime::Seconds();
-    double elapsedTimeMs = (timeAfter - timeBefore) * 1000.0;
-    UE_LOG(HeaderLookupTableSub, Display, TEXT("Initialized header lookup table in %f ms"), elapsedTimeMs);
 }
 
-FString UHeaderLookupTable::GetIncludeFilePathFor(FString className) {
-    if (_lookupTable.Contains(className)) {
-        return _lookupTable[className];
+/**
+ * Removes everything the given module contributed to the table.
+ */
+void UHeaderLookupTable::RemoveModule(FName moduleName) {
+    FHeaderModuleIndex* moduleIndex = _moduleIndices.Find(moduleName);
+    if (moduleIndex == nullptr) {
+        return;
     }
+
+    const uint16* moduleIdPtr = GetCurrentIndex().ModuleIds.Find(moduleName);
+    if (moduleIdPtr == nullptr) {
+        // It never added anything to this index
+        _moduleIndices.Remove(moduleName);
+        return;
+    }
+
+    uint16 moduleId = *moduleIdPtr;
+    FHeaderIndexData& index = GetWritableIndex();
+    for (FName className : moduleIndex->ClassNames) {
+        FHeaderCandidates* candidates = index.LookupTable.Find(className);
+        if (candidates != nullptr) {
+            candidates->RemoveAll([moduleId] (const FHeaderLookupEntry& entry) { return entry.ModuleId == moduleId; });
+            if (candidates->Num() == 0) {
+                index.LookupTable.Remove(className);
+            }
+        }
+    }
+
+    _moduleIndices.Remove(moduleName);
+}
+
+/**
+ * Adds a header for the given class, keeping the candidates in manifest order.
+ */
+void UHeaderLookupTable::AddEntry(FName className, FStringView includePath, FName moduleName, int32 order) {
+    FHeaderIndexData& index = GetWritableIndex();
+    FHeaderLookupEntry entry = index.MakeEntry(className, includePath, moduleName);
+
+    // Modules are usually added in order so search from the back
+    FHeaderCandidates& candidates = index.LookupTable.FindOrAdd(className);
+    int32 insertIndex = candidates.Num();
+    while (insertIndex > 0) {
+        const FHeaderModuleIndex* previousModule = _moduleIndices.Find(index.ModuleNames[candidates[insertIndex - 1].ModuleId]);
+        if (previousModule != nullptr && previousModule->Order <= order) {
+            break;
+        }
+        insertIndex--;
+    }
+
+    candidates.Insert(entry, insertIndex);
+}
+
+/**
+ * Releases the slack left over from building the table.
+ */
+void UHeaderLookupTable::ShrinkTable() {
+    _moduleIndices.Shrink();
+
+    // Only the pending index can have changed since it was last shrunk
+    if (_pendingIndex.IsValid()) {
+        _pendingIndex->LookupTable.Compact();
+        _pendingIndex->LookupTable.Shrink();
+        _pendingIndex->DirectoryPool.Shrink();
+        _pendingIndex->FileNamePool.Shrink();
+    }
+}
+
+void UHeaderLookupTable::ResetIndex() {
+    // Start from an empty copy. Lookups keep using the published one until it's replaced.
+    _pendingIndex = MakeUnique<FHeaderIndexData>();
+    _moduleIndices.Empty();
+    _indexedManifestPath.Empty();
+    _indexedManifestSize = -1;
+    _indexedManifestTimestamp = 0;
+    _indexedManifestHash = FMD5Hash();
+}
+
+/**
+ * Returns the include path UHT recorded for the class or an empty string if it has none.
+ * This is only available in editor builds which is the only place this plugin runs anyway.
+ */
+FString UHeaderLookupTable::GetIncludePathFromMetadata(UClass* nativeClass) {
+#if WITH_EDITORONLY_DATA
+    static const FName includePathKey(TEXT("IncludePath"));
+    static const FName moduleRelativePathKey(TEXT("ModuleRelativePath"));
+
+    // IncludePath is already relative to the include roots of the module
+    const FString& includePath = nativeClass->GetMetaData(includePathKey);
+    if (!includePath.IsEmpty()) {
+        return includePath;
+    }
+
+    // ModuleRelativePath still has the Public/Private/Classes folder in it
+    FString moduleRelativePath = nativeClass->GetMetaData(moduleRelativePathKey);
+    if (!moduleRelativePath.IsEmpty()) {
+        FPaths::NormalizeFilename(moduleRelativePath);
+        for (const TCHAR* prefix : { TEXT("Public/"), TEXT("Private/"), TEXT("Classes/") }) {
+            if (moduleRelativePath.StartsWith(prefix)) {
+                return moduleRelativePath.RightChop(FCString::Strlen(prefix));
+            }
+        }
+        return moduleRelativePath;
+    }
+#endif
+
     return FString();
 }
+
+/**
+ * Returns the name of the module a native class is declared in.
+ */
+FName UHeaderLookupTable::GetModuleNameForClass(UClass* nativeClass) {
+    // Native classes live in a package named after their module like /Script/UMG
+    FString packageName = nativeClass->GetOutermost()->GetName();
+    return FName(*FPackageName::GetShortName(packageName));
+}
+
+/**
+ * Hashes everything about a module that affects what it contributes to the table.
+ */
+uint64 UHeaderLookupTable::ComputeModuleFingerprint(const FUhtModuleHeaders& moduleHeaders) {
+    uint64 fingerprint = CityHash64((const char*)*moduleHeaders.BaseDirectory, moduleHeaders.BaseDirectory.Len() * sizeof(TCHAR));
+
+    // Include the count of each array so moving a header from one list to another changes the hash
+    auto hashHeaders = [&fingerprint] (const TArray<FString>& headerArray) {
+        int32 headerCount = headerArray.Num();
+        fingerprint = CityHash64WithSeed((const char*)&headerCount, sizeof(headerCount), fingerprint);
+        for (const FString& headerPath : headerArray) {
+            fingerprint = CityHash64WithSeed((const char*)*headerPath, headerPath.Len() * sizeof(TCHAR), fingerprint);
+        }
+    };
+    hashHeaders(moduleHeaders.PrivateHeaders);
+    hashHeaders(moduleHeaders.InternalHeaders);
+    hashHeaders(moduleHeaders.PublicHeaders);
+
+    return fingerprint;
+}
+
+void UHeaderLookupTable::OnManifestDirectoryChanged(const TArray<FFileChangeData>& fileChanges) {
+    FString manifestFileName = FPaths::GetCleanFilename(GetManifestFilePath());
+    for (const FFileChangeData& change : fileChanges) {
+        if (FPaths::GetCleanFilename(change.Filename).Equals(manifestFileName)) {
+            UE_LOG(HeaderLookupTableSub, Verbose, TEXT("UHT manifest changed, invalidating the header lookup table."));
+            Invalidate();
+            return;
+        }
+    }
+}
+
+void UHeaderLookupTable::OnLiveCodingPatchComplete() {
+    Invalidate();
+}
+
+void UHeaderLookupTable::OnReloadComplete(EReloadCompleteReason reason) {
+    // Reloaded classes are new objects so anything we remembered about the old ones is useless
+    _classIncludePaths.Empty();
+    Invalidate();
+}
+
+/**
+ * Reads and writes the part of the cache file that identifies the manifest it was built from.
+ */
+void UHeaderLookupTable::SerializeCacheHeader(FArchive& archive, FString& manifestPath, int64& manifestSize, int64& manifestTimestamp, FMD5Hash& manifestHash) {
+    uint32 magic = CacheFileMagic;
+    uint32 version = CacheFileVersion;
+    archive << magic;
+    archive << version;
+    if (archive.IsLoading() && (magic != CacheFileMagic || version != CacheFileVersion)) {
+        archive.SetError();
+        return;
+    }
+
+    archive << manifestPath;
+    archive << manifestSize;
+    archive << manifestTimestamp;
+    archive << manifestHash;
+}
+
+/**
+ * Fills the table from the binary cache. The cache may have been built from an
+ * older manifest so check IsIndexCurrent before relying on it.
+ * @return Returns false if there is no usable cache.
+ */
+bool UHeaderLookupTable::LoadCache() {
+    FString cachePath = GetCacheFilePath();
+    if (!IFileManager::Get().FileExists(*cachePath)) {
+        return false;
+    }
+
+    FReadOnlyFileView cacheFile;
+    if (!cacheFile.Open(cachePath)) {
+        return false;
+    }
+
+    FMemoryReaderView reader(cacheFile.GetView());
+    FString cachedManifestPath;
+    int64 cachedManifestSize = 0;
+    int64 cachedManifestTimestamp = 0;
+    FMD5Hash cachedManifestHash;
+    SerializeCacheHeader(reader, cachedManifestPath, cachedManifestSize, cachedManifestTimestamp, cachedManifestHash);
+    if (reader.IsError()) {
+        UE_LOG(HeaderLookupTableSub, Display, TEXT("Header lookup cache at %s is from an older version and will be rebuilt."), *cachePath);
+        return false;
+    }
+
+    // Modules are written in manifest order so each entry is appended to its candidates
+    ResetIndex();
+    int32 moduleCount = 0;
+    reader << moduleCount;
+    bool isValid = !reader.IsError() && moduleCount >= 0 && moduleCount <= reader.TotalSize();
+    for (int32 moduleIndex = 0; isValid && moduleIndex < moduleCount; moduleIndex++) {
+        FString moduleNameStr;
+        uint64 fingerprint = 0;
+        int32 order = 0;
+        int32 entryCount = 0;
+        reader << moduleNameStr;
+        reader << fingerprint;
+        reader << order;
+        reader << entryCount;
+        if (reader.IsError() || entryCount < 0 || entryCount > reader.TotalSize()) {
+            isValid = false;
+            break;
+        }
+
+        FName moduleName(*moduleNameStr);
+        FHeaderModuleIndex& moduleEntry = _moduleIndices.Add(moduleName);
+        moduleEntry.Fingerprint = fingerprint;
+        moduleEntry.Order = order;
+        moduleEntry.ClassNames.Reserve(entryCount);
+        for (int32 i = 0; i < entryCount && !reader.IsError(); i++) {
+            FString className;
+            FString includePath;
+            reader << className;
+            reader << includePath;
+
+            FName classFName(*className);
+            AddEntry(classFName, includePath, moduleName, order);
+            moduleEntry.ClassNames.Add(classFName);
+        }
+        isValid = !reader.IsError();
+    }
+
+    if (!isValid) {
+        UE_LOG(HeaderLookupTableSub, Warning, TEXT("Header lookup cache at %s is corrupt and will be rebuilt."), *cachePath);
+        ResetIndex();
+        return false;
+    }
+
+    _indexedManifestPath = cachedManifestPath;
+    _indexedManifestSize = cachedManifestSize;
+    _indexedManifestTimestamp = cachedManifestTimestamp;
+    _indexedManifestHash = cachedManifestHash;
+    return true;
+}
+
+/**
+ * Writes the current table to the binary cache file.
+ * @return Returns false if the file could not be written.
+ */
+bool UHeaderLookupTable::SaveCache() {
+    TArray<uint8> cacheBuffer;
+    FMemoryWriter writer(cacheBuffer);
+    SerializeCacheHeader(writer, _indexedManifestPath, _indexedManifestSize, _indexedManifestTimestamp, _indexedManifestHash);
+
+    // Write the modules in manifest order so loading can append to each candidate list
+    TArray<FName> moduleNames;
+    _moduleIndices.GetKeys(moduleNames);
+    moduleNames.Sort([this] (const FName& a, const FName& b) { return _moduleIndices[a].Order < _moduleIndices[b].Order; });
+
+    const FHeaderIndexData& index = GetCurrentIndex();
+    int32 moduleCount = moduleNames.Num();
+    writer << moduleCount;
+    for (FName moduleName : moduleNames) {
+        FHeaderModuleIndex& moduleIndex = _moduleIndices[moduleName];
+        FString moduleNameStr = moduleName.ToString();
+        int32 entryCount = moduleIndex.ClassNames.Num();
+        writer << moduleNameStr;
+        writer << moduleIndex.Fingerprint;
+        writer << moduleIndex.Order;
+        writer << entryCount;
+
+        const uint16* moduleId = index.ModuleIds.Find(moduleName);
+        for (FName className : moduleIndex.ClassNames) {
+            FString includePath;
+            const FHeaderCandidates* candidates = index.LookupTable.Find(className);
+            if (candidates != nullptr && moduleId != nullptr) {
+                const FHeaderLookupEntry* entry = candidates->FindByPredicate([moduleId] (const FHeaderLookupEntry& candidate) { return candidate.ModuleId == *moduleId; });
+                if (entry != nullptr) {
+                    includePath = index.BuildIncludePath(className, *entry);
+                }
+            }
+
+            FString classNameStr = className.ToString();
+            writer << classNameStr;
+            writer << includePath;
+        }
+    }
+
+    FString cachePath = GetCacheFilePath();
+    if (!FFileHelper::SaveArrayToFile(cacheBuffer, *cachePath)) {
+        UE_LOG(HeaderLookupTableSub, Warning, TEXT("Failed to save the header lookup cache to %s"), *cachePath);
+        return false;
+    }
+
+    return true;
+}
@@ -1,12 +1,129 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Misc/SecureHash.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "UObject/UObjectGlobals.h"
+#include "Memory/MemoryView.h"
+#include "UObject/ObjectKey.h"
+#include "UhtManifestReader.h"
+#include "StringPool.h"
 #include "HeaderLookupTable.generated.h"
 
+/**
+ * A header that declares a class. The include path is not stored directly.
+ * It's the pooled directory followed by the class name and the extension.
+ */
+struct FHeaderLookupEntry {
+    // Index of the include path's directory (with its trailing slash) in the directory pool
+    int32 DirectoryId = 0;
+
+    // Index of the file name without its extension in the file name pool if it's cased differently
+    // than the class name. FNames ignore case so the class name may not match the file on disk.
+    int32 FileNameId = INDEX_NONE;
+
+    // Index of the module the header is in
+    uint16 ModuleId = 0;
+
+    // Index of the header's file extension
+    uint16 ExtensionId = 0;
+};
+
+// Every module that provides a header for a class, ordered by their position in the manifest.
+// The first one is the header we include.
+using FHeaderCandidates = TArray<FHeaderLookupEntry, TInlineAllocator<1>>;
+
+/**
+ * The contents of the lookup table. Once published, an index is never modified.
+ * Changes are made to a copy that replaces it.
+ */
+struct FHeaderIndexData {
+    // Class Name to Relative Header File Path mapping
+    //    Note: The class name does not include the "U" prefix.
+    //          Ex: "Button" instead of "UButton"
+    TMap<FName, FHeaderCandidates> LookupTable;
+
+    // The parts the include paths in LookupTable are made of. There are only
+    // a few thousand distinct directories for tens of thousands of headers.
+    FStringPool DirectoryPool;
+    FStringPool FileNamePool;
+    TArray<FString> Extensions;
+
+    // Module Id to name and back. Ids are never reused.
+    TArray<FName> ModuleNames;
+    TMap<FName, uint16> ModuleIds;
+
+    // Modules whose entries came from an older manifest and haven't been checked against
+    // the current one yet. Their candidates are skipped by lookups until they are.
+    TSet<uint16> UnverifiedModuleIds;
+
+    /**
+     * Returns the include path for the given class name. If several modules have a header
+     * with that name, the one in preferredModule is used if there is one.
+     */
+    FString FindIncludePath(FName className, FName preferredModule) const;
+    FString BuildIncludePath(FName className, const FHeaderLookupEntry& entry) const;
+
+    /**
+     * Splits an include path into the parts an entry is made of, adding them to the pools as needed.
+     */
+    FHeaderLookupEntry MakeEntry(FName className, FStringView includePath, FName moduleName);
+    bool IsVerified(const FHeaderLookupEntry& entry) const { return !UnverifiedModuleIds.Contains(entry.ModuleId); }
+    uint16 AddModuleName(FName moduleName);
+    uint16 AddExtension(FStringView extension);
+    SIZE_T GetAllocatedSize() const;
+};
+
+/**
+ * Records what a single module contributed to the lookup table so
+ * the module can be re-indexed on its own when it changes.
+ */
+struct FHeaderModuleIndex {
+    // Hash of the module's base directory and header lists
+    uint64 Fingerprint = 0;
+
+    // Position of the module in the manifest. Earlier modules win when class names collide.
+    int32 Order = 0;
+
+    // The class names this module has a header for
+    TArray<FName> ClassNames;
+};
+
 /**
  * This class is used to store a lookup table from class name to
  * header file include path for classes within a project and its
  * dependent modules.
+ *
+ * Native classes carry their include path in their reflection metadata
+ * so that is used first when a class is available. The table built from
+ * the UHT manifest is only a fallback and is not built until it's needed.
+ * In lazy mode, only the module that owns the class being looked up is
+ * indexed rather than every module in the manifest.
+ *
+ * Building the table requires parsing the UHT manifest which can be
+ * very large, so it is mapped into memory and read with a streaming
+ * parser that only extracts the header lists, and the modules are
+ * processed in parallel. The result is cached in a binary index file
+ * under the project's Intermediate directory. The cache is keyed by the
+ * manifest's path, size, modification time and content hash.
+ *
+ * Each module is fingerprinted so when the manifest changes only the
+ * modules whose headers changed are re-indexed.
+ *
+ * The editor keeps the table for the whole session so it is stored compactly.
+ * Class names are FNames and include paths are rebuilt on demand from a pooled
+ * directory, the class name and the extension. The file name is only pooled
+ * when its casing differs from the class name's.
+ *
+ * The table is not thread safe. Lookups may index modules and read class metadata
+ * so they must happen on the thread that builds the table, which is normally the
+ * game thread. A rebuild makes its changes to a private copy of the index that
+ * replaces the published one when it's done. Modules indexed on demand are added
+ * to that copy too so each miss doesn't copy the whole index.
+ *
+ * The table is meant to be long-lived. It is only rebuilt after it has been
+ * invalidated, which happens when the manifest changes on disk or after
+ * a live coding patch or hot reload once StartWatching has been called.
  */
 UCLASS()
 class UHeaderLookupTable : public UObject {
@@ -15,13 +132,136 @@ class UHeaderLookupTable : public UObject {
 public:
     UHeaderLookupTable(const FObjectInitializer& objectInitializer) : UObject(objectInitializer) { }
     virtual ~UHeaderLookupTable() { }
+    virtual void BeginDestroy() override;
 
-    void InitTable();
+    /**
+     * Builds the table from the UHT manifest.
+     * @return Returns false if the manifest could not be found or read.
+     */
+    bool InitTable();
     FString GetIncludeFilePathFor(FString className);
 
+    /**
+     * Returns the path to include to use the given native class or an empty string
+     * if it could not be found. The result is remembered for the next call.
+     * Note: This indexes modules as needed so only call it from the game thread.
+     */
+    FString GetIncludeFilePathFor(UClass* nativeClass);
+
+    /**
+     * Rebuilds the table if it has never been built or has been invalidated since.
+     */
+    void EnsureUpToDate();
+
+    /**
+     * Indexes every module in the manifest now, even in lazy mode.
+     * Note: This may be called from a worker thread as long as nothing else uses the table until it returns.
+     */
+    void BuildFullIndex();
+
+    /**
+     * Marks the table as stale so it is rebuilt on the next EnsureUpToDate.
+     */
+    void Invalidate() { _isStale = true; }
+
+    /**
+     * In lazy mode, modules are only indexed when a class they own is looked up.
+     */
+    void SetLazyIndexing(bool isLazy);
+
+    /**
+     * Returns the number of bytes allocated for the table.
+     */
+    SIZE_T GetAllocatedSize() const;
+
+    /**
+     * Starts listening for changes that should invalidate the table.
+     */
+    void StartWatching();
+    void StopWatching();
+
+    /**
+     * Converts a full header path to the path used to include it from other modules.
+     * Both '\' and '/' separators are accepted. The result always uses '/'.
+     * @param headerPath The full path to the header file.
+     * @param moduleBasePath The base directory of the module the header is in.
+     * @param outIncludePath Set to the include path if successful.
+     * @return Returns false if the header is not in the given module directory.
+     */
+    static bool AbbreviateHeaderPath(const FString& headerPath, const FString& moduleBasePath, FString& outIncludePath);
+
+private: // Methods
+    FString GetManifestFilePath();
+    FString GetCacheFilePath();
+    bool InitLazyTable();
+    void IndexModuleOnDemand(FName moduleName);
+    void SetModulesVerified();
+    FHeaderIndexData& GetWritableIndex();
+    const FHeaderIndexData& GetCurrentIndex() const;
+    void PublishIndex();
+    bool IsIndexCurrent(const FString& manifestPath, const FFileStatData& manifestStat);
+    bool IndexManifest(FMemoryView manifestBytes);
+    void IndexModule(FName moduleName, int32 order, uint64 fingerprint, const TArray<TPair<FName, FString>>& entries);
+    void RemoveModule(FName moduleName);
+    void AddEntry(FName className, FStringView includePath, FName moduleName, int32 order);
+    void ShrinkTable();
+    void LogMemoryUsage() const;
+    void ResetIndex();
+    static void BuildModuleEntries(const struct FUhtModuleHeaders& moduleHeaders, TArray<TPair<FName, FString>>& outEntries);
+    static uint64 ComputeModuleFingerprint(const struct FUhtModuleHeaders& moduleHeaders);
+    static FString GetIncludePathFromMetadata(UClass* nativeClass);
+    static FName GetModuleNameForClass(UClass* nativeClass);
+    bool LoadCache();
+    bool SaveCache();
+    void SerializeCacheHeader(FArchive& archive, FString& manifestPath, int64& manifestSize, int64& manifestTimestamp, FMD5Hash& manifestHash);
+
+private: // Callbacks
+    void OnManifestDirectoryChanged(const TArray<struct FFileChangeData>& fileChanges);
+    void OnLiveCodingPatchComplete();
+    void OnReloadComplete(EReloadCompleteReason reason);
+
 private:
-    // Class Name to Relative Header File Path mapping
-    //    Note: The class name does not include the "U" prefix.
-    //          Ex: "Button" instead of "UButton"
-    TMap<FString, FString> _lookupTable;
+    // The published index. It is only replaced, never modified.
+    TUniquePtr<const FHeaderIndexData> _snapshot;
+
+    // The copy of the index that's being changed. It's published by PublishIndex.
+    TUniquePtr<FHeaderIndexData> _pendingIndex;
+
+    // Include paths that have already been resolved for a class
+    TMap<FObjectKey, FString> _classIncludePaths;
+
+    // Classes we could not find a header for since the table was last invalidated
+    TSet<FObjectKey> _unresolvedClasses;
+
+    // Module Name to what it contributed to the index
+    TMap<FName, FHeaderModuleIndex> _moduleIndices;
+
+    // True when every module in the manifest has been indexed
+    bool _isIndexComplete = false;
+
+    // Lazy mode state. Where each module is in the manifest and
+    // which modules have been checked against it since it was scanned.
+    bool _isLazy = false;
+    TMap<FName, struct FUhtModuleLocation> _moduleLocations;
+    TSet<FName> _verifiedModules;
+
+    // Identifies the manifest the current table was built from
+    FString _indexedManifestPath;
+    int64 _indexedManifestSize = -1;
+    int64 _indexedManifestTimestamp = 0;
+    FMD5Hash _indexedManifestHash;
+
+    // True until the table has been built and whenever it is invalidated after that
+    bool _isStale = true;
+
+    // Watcher state so we can unregister everything when we're destroyed
+    bool _isWatching = false;
+    FString _watchedManifestDirectory;
+    FDelegateHandle _manifestWatcherHandle;
+    FDelegateHandle _liveCodingHandle;
+    FDelegateHandle _reloadCompleteHandle;
+
+    // Identifies the binary cache file format. Bump the version when the layout changes.
+    const static inline uint32 CacheFileMagic = 0x49484355; // "UCHI"
+    const static inline uint32 CacheFileVersion = 3;
 };
@@ -0,0 +1,148 @@
+#include "SectionSplicer.h"
+
+FStringView FSectionLayout::GetBody(int32 sectionId) const {
+    if (!HasSection(sectionId)) {
+        return FStringView();
+    }
+
+    const FSectionLocation& location = Sections[sectionId];
+    return Contents.Mid(location.BodyStart, location.SuffixStart - location.BodyStart);
+}
+
+int32 FSectionSplicer::AddSection(const FString& name, const FString& prefix, const FString& suffix) {
+    int32 sectionId = _sections.Add({ name, prefix, suffix });
+
+    for (bool isPrefix : { true, false }) {
+        const FString& text = isPrefix ? prefix : suffix;
+        if (text.IsEmpty()) {
+            continue; // Can never match
+        }
+
+        _markers.Add({ sectionId, isPrefix });
+        _firstCharacters.AddUnique(text[0]);
+    }
+
+    _markers.StableSort([this] (const FMarker& first, const FMarker& second) {
+        const FSection& firstSection = _sections[first.SectionId];
+        const FSection& secondSection = _sections[second.SectionId];
+        int32 firstLength = first.IsPrefix ? firstSection.Prefix.Len() : firstSection.Suffix.Len();
+        int32 secondLength = second.IsPrefix ? secondSection.Prefix.Len() : secondSection.Suffix.Len();
+        return firstLength > secondLength;
+    });
+
+    return sectionId;
+}
+
+bool FSectionSplicer::MatchMarker(FStringView remaining, FMarker& outMarker) const {
+    for (const FMarker& marker : _markers) {
+        const FSection& section = _sections[marker.SectionId];
+        if (remaining.StartsWith(marker.IsPrefix ? section.Prefix : section.Suffix, ESearchCase::CaseSensitive)) {
+            outMarker = marker;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool FSectionSplicer::FindSections(FStringView contents, FSectionLayout& outLayout, FString& outError) const {
+    outLayout.Contents = contents;
+    outLayout.Sections.Reset();
+    outLayout.Sections.SetNum(_sections.Num());
+
+    int32 openSectionId = INDEX_NONE;
+    int32 index = 0;
+    while (index < contents.Len()) {
+        FMarker marker;
+        if (!_firstCharacters.Contains(contents[index]) || !MatchMarker(contents.RightChop(index), marker)) {
+            index++;
+            continue;
+        }
+
+        const FSection& section = _sections[marker.SectionId];
+        FSectionLocation& location = outLayout.Sections[marker.SectionId];
+        if (marker.IsPrefix) {
+            if (location.PrefixStart != INDEX_NONE) {
+                outError = FString::Printf(TEXT("The %s section starts again on line %d"), *section.Name, GetLineNumber(contents, index));
+                return false;
+            }
+            if (openSectionId != INDEX_NONE) {
+                outError = FString::Printf(TEXT("The %s section starts inside the %s section on line %d"), *section.Name, *_sections[openSectionId].Name, GetLineNumber(contents, index));
+                return false;
+            }
+
+            location.PrefixStart = index;
+            location.BodyStart = index + section.Prefix.Len();
+            openSectionId = marker.SectionId;
+            index = location.BodyStart;
+        } else {
+            if (location.SuffixStart != INDEX_NONE) {
+                outError = FString::Printf(TEXT("The %s section ends again on line %d"), *section.Name, GetLineNumber(contents, index));
+                return false;
+            }
+            if (openSectionId != marker.SectionId) {
+                outError = FString::Printf(TEXT("The %s section ends on line %d but was never started"), *section.Name, GetLineNumber(contents, index));
+                return false;
+            }
+
+            location.SuffixStart = index;
+            index += section.Suffix.Len();
+
+            // The line break after the suffix belongs to the section
+            if (index < contents.Len() && contents[index] == TEXT('\r')) {
+                index++;
+            }
+            if (index < contents.Len() && contents[index] == TEXT('\n')) {
+                index++;
+            }
+            location.End = index;
+            openSectionId = INDEX_NONE;
+        }
+    }
+
+    if (openSectionId != INDEX_NONE) {
+        const FSectionLocation& location = outLayout.Sections[openSectionId];
+        outError = FString::Printf(TEXT("The %s section started on line %d never ends"), *_sections[openSectionId].Name, GetLineNumber(contents, location.PrefixStart));
+        return false;
+    }
+
+    return true;
+}
+
+void FSectionSplicer::Splice(const FSectionLayout& layout, FString& output, int32 extraCapacity, TFunctionRef<void(int32 sectionId, FStringView body, FString& output)> writeBody) const {
+    // Write the sections in the order they're in the file
+    TArray<int32, TInlineAllocator<4>> sectionIds;
+    for (int32 sectionId = 0; sectionId < layout.Sections.Num(); sectionId++) {
+        if (layout.Sections[sectionId].IsFound()) {
+            sectionIds.Add(sectionId);
+        }
+    }
+    sectionIds.Sort([&layout] (int32 first, int32 second) {
+        return layout.Sections[first].PrefixStart < layout.Sections[second].PrefixStart;
+    });
+
+    output.Reserve(output.Len() + layout.Contents.Len() + extraCapacity);
+
+    int32 copiedUpTo = 0;
+    for (int32 sectionId : sectionIds) {
+        const FSectionLocation& location = layout.Sections[sectionId];
+
+        // Everything up to and including the prefix stays the same
+        output.Append(layout.Contents.GetData() + copiedUpTo, location.BodyStart - copiedUpTo);
+        writeBody(sectionId, layout.GetBody(sectionId), output);
+        output.Append(layout.Contents.GetData() + location.SuffixStart, location.End - location.SuffixStart);
+        copiedUpTo = location.End;
+    }
+
+    output.Append(layout.Contents.GetData() + copiedUpTo, layout.Contents.Len() - copiedUpTo);
+}
+
+int32 FSectionSplicer::GetLineNumber(FStringView contents, int32 index) {
+    int32 lineNumber = 1;
+    for (int32 characterIndex = 0; characterIndex < index && characterIndex < contents.Len(); characterIndex++) {
+        if (contents[characterIndex] == TEXT('\n')) {
+            lineNumber++;
+        }
+    }
+    return lineNumber;
+}
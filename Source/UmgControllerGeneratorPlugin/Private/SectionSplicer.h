@@ -0,0 +1,95 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Where a generated section is in a file. Each index is relative to the start of the file.
+ */
+struct FSectionLocation {
+    int32 PrefixStart = INDEX_NONE;
+
+    // The body is everything between the end of the prefix and the start of the suffix
+    int32 BodyStart = INDEX_NONE;
+    int32 SuffixStart = INDEX_NONE;
+
+    // Just past the suffix and the line break after it, if there is one
+    int32 End = INDEX_NONE;
+
+    bool IsFound() const { return PrefixStart != INDEX_NONE; }
+};
+
+/**
+ * The generated sections found in a file. The views point into the contents
+ * that were searched so they are only valid as long as those are.
+ */
+struct FSectionLayout {
+    FStringView Contents;
+
+    // Indexed by section id
+    TArray<FSectionLocation, TInlineAllocator<4>> Sections;
+
+    bool HasSection(int32 sectionId) const { return Sections.IsValidIndex(sectionId) && Sections[sectionId].IsFound(); }
+    FStringView GetBody(int32 sectionId) const;
+};
+
+/**
+ * Finds the generated sections in a source file and rebuilds the file with new section bodies.
+ * Every section marker is found in a single pass over the file and everything outside of the
+ * section bodies is copied straight from the original contents.
+ *
+ * The splicer only holds the markers so once the sections are added it can be shared.
+ */
+class FSectionSplicer {
+public:
+    /**
+     * Adds a section with the given markers. Sections are identified by the order they are added in.
+     * @param name What to call the section in error messages.
+     * @return Returns the id of the section.
+     */
+    int32 AddSection(const FString& name, const FString& prefix, const FString& suffix);
+
+    int32 Num() const { return _sections.Num(); }
+    const FString& GetPrefix(int32 sectionId) const { return _sections[sectionId].Prefix; }
+    const FString& GetSuffix(int32 sectionId) const { return _sections[sectionId].Suffix; }
+
+    /**
+     * Finds every section in the given contents. Sections that aren't in the file are not an error.
+     * @param outError Set to a description of the problem if the markers are malformed. A marker that
+     *                 appears twice, a prefix without a suffix (or the reverse) and a section that
+     *                 starts inside another one are all errors.
+     * @return Returns false if the markers are malformed.
+     */
+    bool FindSections(FStringView contents, FSectionLayout& outLayout, FString& outError) const;
+
+    /**
+     * Rebuilds the contents of the given layout into output with the body of each section that was
+     * found replaced with whatever writeBody appends. The markers themselves are kept as they were.
+     * @param extraCapacity How much longer the output is expected to be than the original contents.
+     */
+    void Splice(const FSectionLayout& layout, FString& output, int32 extraCapacity, TFunctionRef<void(int32 sectionId, FStringView body, FString& output)> writeBody) const;
+
+private:
+    struct FSection {
+        FString Name;
+        FString Prefix;
+        FString Suffix;
+    };
+
+    struct FMarker {
+        int32 SectionId = 0;
+        bool IsPrefix = false;
+    };
+
+    bool MatchMarker(FStringView remaining, FMarker& outMarker) const;
+    static int32 GetLineNumber(FStringView contents, int32 index);
+
+private:
+    TArray<FSection> _sections;
+
+    // Every marker sorted longest first so a marker that starts with another one is matched first
+    TArray<FMarker> _markers;
+
+    // The first character of each marker. Most characters in a file aren't one of these so
+    // they can be skipped without comparing against each marker.
+    TArray<TCHAR, TInlineAllocator<8>> _firstCharacters;
+};
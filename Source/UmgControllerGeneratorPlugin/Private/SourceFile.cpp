@@ -0,0 +1,142 @@
+#include "SourceFile.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+#else
+#include <stdio.h>
+#endif
+
+DEFINE_LOG_CATEGORY_STATIC(SourceFileSub, Log, All)
+
+bool FSourceFile::Load(const FString& filePath) {
+    TArray<uint8> bytes;
+    if (!FFileHelper::LoadFileToArray(bytes, *filePath)) {
+        return false;
+    }
+
+    if (bytes.Num() >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF) {
+        Encoding = ESourceFileEncoding::Utf8WithBom;
+    } else if (bytes.Num() >= 2 && ((bytes[0] == 0xFF && bytes[1] == 0xFE) || (bytes[0] == 0xFE && bytes[1] == 0xFF))) {
+        // Big endian files are rare enough that they're written back as little endian
+        Encoding = ESourceFileEncoding::Utf16LittleEndian;
+    } else {
+        Encoding = ESourceFileEncoding::Utf8;
+    }
+
+    // This handles the byte order marks
+    FString text;
+    FFileHelper::BufferToString(text, bytes.GetData(), bytes.Num());
+    SetContents(MoveTemp(text));
+    return true;
+}
+
+void FSourceFile::SetContents(FString text) {
+    // Whichever line break comes first is the one the file uses
+    int32 lineBreakIndex = INDEX_NONE;
+    UsesCrlf = text.FindChar(TEXT('\n'), lineBreakIndex) && lineBreakIndex > 0 && text[lineBreakIndex - 1] == TEXT('\r');
+
+    Contents = MoveTemp(text);
+    if (Contents.Contains(TEXT("\r\n"), ESearchCase::CaseSensitive)) {
+        Contents.ReplaceInline(TEXT("\r\n"), TEXT("\n"), ESearchCase::CaseSensitive);
+    }
+}
+
+bool FSourceFile::Save(const FString& filePath, bool& outWasWritten) const {
+    outWasWritten = false;
+
+    TArray<uint8> bytes;
+    Encode(bytes);
+
+    // Leave the file alone if nothing changed
+    if (FileMatches(filePath, bytes)) {
+        return true;
+    }
+
+    if (!WriteAtomically(filePath, bytes)) {
+        return false;
+    }
+
+    outWasWritten = true;
+    return true;
+}
+
+bool FSourceFile::IsSavedAt(const FString& filePath) const {
+    TArray<uint8> bytes;
+    Encode(bytes);
+    return FileMatches(filePath, bytes);
+}
+
+bool FSourceFile::FileMatches(const FString& filePath, const TArray<uint8>& bytes) {
+    // Checking the size first avoids reading files that are obviously different
+    if (IFileManager::Get().FileSize(*filePath) != bytes.Num()) {
+        return false;
+    }
+
+    TArray<uint8> existingBytes;
+    return FFileHelper::LoadFileToArray(existingBytes, *filePath, FILEREAD_Silent) && existingBytes == bytes;
+}
+
+void FSourceFile::Encode(TArray<uint8>& outBytes) const {
+    FString text = UsesCrlf ? Contents.Replace(TEXT("\n"), TEXT("\r\n"), ESearchCase::CaseSensitive) : Contents;
+
+    if (Encoding == ESourceFileEncoding::Utf16LittleEndian) {
+        FTCHARToUTF16 converter(*text, text.Len());
+        outBytes.Reserve(2 + converter.Length() * sizeof(UTF16CHAR));
+        outBytes.Add(0xFF);
+        outBytes.Add(0xFE);
+        const UTF16CHAR* characters = converter.Get();
+        for (int32 index = 0; index < converter.Length(); index++) {
+            outBytes.Add(characters[index] & 0xFF);
+            outBytes.Add((characters[index] >> 8) & 0xFF);
+        }
+    } else {
+        FTCHARToUTF8 converter(*text, text.Len());
+        outBytes.Reserve(3 + converter.Length());
+        if (Encoding == ESourceFileEncoding::Utf8WithBom) {
+            outBytes.Append({ 0xEF, 0xBB, 0xBF });
+        }
+        outBytes.Append(reinterpret_cast<const uint8*>(converter.Get()), converter.Length());
+    }
+}
+
+bool FSourceFile::WriteAtomically(const FString& filePath, const TArray<uint8>& bytes) {
+    IFileManager& fileManager = IFileManager::Get();
+    FString fullFilePath = FPaths::ConvertRelativePathToFull(filePath);
+    if (fileManager.IsReadOnly(*fullFilePath)) {
+        UE_LOG(SourceFileSub, Warning, TEXT("Failed to replace %s because it's read only."), *fullFilePath);
+        return false;
+    }
+
+    // Keep the temporary file in the same directory so replacing the original is just a rename.
+    // Each write gets its own name so two writes to the same file can't clobber each other's.
+    FString temporaryFilePath = FPaths::CreateTempFilename(*FPaths::GetPath(fullFilePath), *(FPaths::GetCleanFilename(fullFilePath) + TEXT(".")), TEXT(".tmp"));
+    if (!FFileHelper::SaveArrayToFile(bytes, *temporaryFilePath)) {
+        // The original hasn't been touched yet so the partial file is all there is to clean up
+        UE_LOG(SourceFileSub, Warning, TEXT("Failed to write %s"), *temporaryFilePath);
+        fileManager.Delete(*temporaryFilePath, false, false, true);
+        return false;
+    }
+
+    if (!ReplaceFile(temporaryFilePath, fullFilePath)) {
+        // Leave the new contents where they are. The original may already be gone so they could be the only copy.
+        UE_LOG(SourceFileSub, Error, TEXT("Failed to replace %s. The new contents were left in %s."), *fullFilePath, *temporaryFilePath);
+        return false;
+    }
+
+    return true;
+}
+
+bool FSourceFile::ReplaceFile(const FString& sourcePath, const FString& destinationPath) {
+    // IFileManager::Move deletes the destination before moving so it isn't atomic. Renaming
+    // over the destination replaces it in one step on both Windows and POSIX file systems.
+#if PLATFORM_WINDOWS
+    return ::MoveFileExW(*sourcePath, *destinationPath, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return ::rename(TCHAR_TO_UTF8(*sourcePath), TCHAR_TO_UTF8(*destinationPath)) == 0;
+#endif
+}
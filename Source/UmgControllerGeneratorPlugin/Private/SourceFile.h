@@ -0,0 +1,61 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * How a source file's text is stored on disk.
+ */
+enum class ESourceFileEncoding : uint8 {
+    Utf8,
+    Utf8WithBom,
+    Utf16LittleEndian
+};
+
+/**
+ * The text of a source file along with how it was encoded and which line breaks it used,
+ * so it can be edited with plain '\n' line breaks and written back the way it was.
+ *
+ * Saving only writes the file if the bytes are different from what's already on disk,
+ * so updating a controller that hasn't changed doesn't touch its timestamp and cause
+ * everything that includes it to be rebuilt. Changes are written to a uniquely named
+ * temporary file next to the original which is then renamed over it, so a failed write
+ * can't leave a partially written source file behind. If the rename fails, the temporary
+ * file is kept and its path is logged.
+ */
+struct FSourceFile {
+    // The text with every line break as '\n'
+    FString Contents;
+
+    ESourceFileEncoding Encoding = ESourceFileEncoding::Utf8;
+    bool UsesCrlf = false;
+
+    /**
+     * Loads the file at the given path.
+     * @return Returns false if the file could not be read.
+     */
+    bool Load(const FString& filePath);
+
+    /**
+     * Sets the contents from text that may have either kind of line break. The line breaks
+     * the text uses are the ones it will be saved with.
+     */
+    void SetContents(FString text);
+
+    /**
+     * Writes the file to the given path if it's different from what's there.
+     * @param outWasWritten Set to false if the file already had these contents.
+     * @return Returns false if the file needed to be written but could not be.
+     */
+    bool Save(const FString& filePath, bool& outWasWritten) const;
+
+    /**
+     * Returns true if the file at the given path already has exactly these contents.
+     */
+    bool IsSavedAt(const FString& filePath) const;
+
+private:
+    void Encode(TArray<uint8>& outBytes) const;
+    static bool FileMatches(const FString& filePath, const TArray<uint8>& bytes);
+    static bool WriteAtomically(const FString& filePath, const TArray<uint8>& bytes);
+    static bool ReplaceFile(const FString& sourcePath, const FString& destinationPath);
+};
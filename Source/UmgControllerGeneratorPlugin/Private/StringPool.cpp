@@ -0,0 +1,44 @@
+#include "StringPool.h"
+
+int32 FStringPool::Add(FStringView value) {
+    uint32 hash = FCrc::MemCrc32(value.GetData(), value.Len() * sizeof(TCHAR));
+
+    TArray<int32, TInlineAllocator<4>> candidates;
+    _indicesByHash.MultiFind(hash, candidates);
+    for (int32 index : candidates) {
+        if (Get(index).Equals(value, ESearchCase::CaseSensitive)) {
+            return index;
+        }
+    }
+
+    int32 index = _offsets.Add(_characters.Num());
+    _characters.Append(value.GetData(), value.Len());
+    _indicesByHash.Add(hash, index);
+    return index;
+}
+
+FStringView FStringPool::Get(int32 index) const {
+    if (!_offsets.IsValidIndex(index)) {
+        return FStringView();
+    }
+
+    int32 start = _offsets[index];
+    int32 end = index + 1 < _offsets.Num() ? _offsets[index + 1] : _characters.Num();
+    return FStringView(_characters.GetData() + start, end - start);
+}
+
+void FStringPool::Empty() {
+    _characters.Empty();
+    _offsets.Empty();
+    _indicesByHash.Empty();
+}
+
+void FStringPool::Shrink() {
+    _characters.Shrink();
+    _offsets.Shrink();
+    _indicesByHash.Shrink();
+}
+
+SIZE_T FStringPool::GetAllocatedSize() const {
+    return _characters.GetAllocatedSize() + _offsets.GetAllocatedSize() + _indicesByHash.GetAllocatedSize();
+}
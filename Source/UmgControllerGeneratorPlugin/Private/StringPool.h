@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Stores deduplicated strings back to back in a single buffer. Each string
+ * is identified by an index so it can be referenced with 4 bytes instead
+ * of an FString and its own heap allocation.
+ * Note: Strings are never removed. Call Empty to start over.
+ */
+class FStringPool {
+public:
+    /**
+     * Adds the string if it isn't already in the pool.
+     * @return Returns the index of the string.
+     */
+    int32 Add(FStringView value);
+
+    /**
+     * Returns the string with the given index. The view is only valid until the next Add.
+     */
+    FStringView Get(int32 index) const;
+
+    int32 Num() const { return _offsets.Num(); }
+    void Empty();
+    void Shrink();
+    SIZE_T GetAllocatedSize() const;
+
+private:
+    // All the strings without terminators
+    TArray<TCHAR> _characters;
+
+    // Where each string starts in _characters. It ends where the next one starts.
+    TArray<int32> _offsets;
+
+    // String hash to the indices of the strings with that hash
+    TMultiMap<uint32, int32> _indicesByHash;
+};
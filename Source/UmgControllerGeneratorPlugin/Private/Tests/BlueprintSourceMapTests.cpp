@@ -0,0 +1,103 @@
+#include "BlueprintSourceMap.h"
+#include "WidgetBlueprint.h"
+#include "Misc/AutomationTest.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "UObject/UObjectIterator.h"
+#include "UObject/UObjectHash.h"
+#include "UObject/Package.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace {
+    TSet<FName> GetLoadedPackageNames() {
+        TSet<FName> packageNames;
+        for (TObjectIterator<UPackage> packageIt; packageIt; ++packageIt) {
+            packageNames.Add(packageIt->GetFName());
+        }
+        return packageNames;
+    }
+
+    /**
+     * Unloads the packages that weren't loaded before so the benchmark doesn't leave them behind.
+     */
+    void UnloadPackagesExcept(const TSet<FName>& keptPackages) {
+        for (TObjectIterator<UPackage> packageIt; packageIt; ++packageIt) {
+            UPackage* package = *packageIt;
+            if (!keptPackages.Contains(package->GetFName()) && !package->IsDirty()) {
+                ForEachObjectWithPackage(package, [] (UObject* object) {
+                    object->ClearFlags(RF_Standalone);
+                    return true;
+                });
+            }
+        }
+        CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBlueprintSourceMapExistenceBenchmark, "UmgControllerGenerator.BlueprintSourceMap.ExistenceBenchmark",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FBlueprintSourceMapExistenceBenchmark::RunTest(const FString& parameters) {
+    IAssetRegistry& assetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+    assetRegistry.SearchAllAssets(true);
+
+    // A synthetic map of the widget blueprints that exist and aren't loaded yet, so the old check
+    // has to load them, padded out with blueprints that were deleted
+    const int32 mappingCount = 5000;
+    const int32 maxExistingCount = 200;
+    TArray<FAssetData> widgetBlueprints;
+    assetRegistry.GetAssetsByClass(UWidgetBlueprint::StaticClass()->GetClassPathName(), widgetBlueprints, true);
+
+    TArray<FString> blueprintPaths;
+    TSet<FString> expectedBlueprints;
+    for (const FAssetData& widgetBlueprint : widgetBlueprints) {
+        if (expectedBlueprints.Num() >= maxExistingCount) {
+            break;
+        }
+        if (!widgetBlueprint.IsAssetLoaded()) {
+            FString blueprintPath = widgetBlueprint.GetSoftObjectPath().ToString();
+            blueprintPaths.Add(blueprintPath);
+            expectedBlueprints.Add(blueprintPath);
+        }
+    }
+    for (int32 index = 0; blueprintPaths.Num() < mappingCount; index++) {
+        blueprintPaths.Add(FString::Printf(TEXT("/Game/UmgControllerGeneratorBenchmark/WBP_Deleted%d.WBP_Deleted%d"), index, index));
+    }
+
+    TSet<FName> packagesBefore = GetLoadedPackageNames();
+    uint64 memoryBefore = FPlatformMemory::GetStats().UsedPhysical;
+    double startTime = FPlatformTime::Seconds();
+    TSet<FString> existingBlueprints = UBlueprintSourceMap::FindExistingBlueprints(blueprintPaths);
+    double registrySeconds = FPlatformTime::Seconds() - startTime;
+    int64 registryMemoryKb = ((int64)FPlatformMemory::GetStats().UsedPhysical - (int64)memoryBefore) / 1024;
+    int32 registryLoadedPackageCount = GetLoadedPackageNames().Difference(packagesBefore).Num();
+
+    TestEqual(TEXT("Every blueprint that exists is found"), existingBlueprints.Num(), expectedBlueprints.Num());
+    TestTrue(TEXT("Only blueprints that exist are found"), existingBlueprints.Difference(expectedBlueprints).Num() == 0);
+    TestEqual(TEXT("The asset registry check doesn't load any packages"), registryLoadedPackageCount, 0);
+
+    // The way it used to be done. The warnings for the missing ones are left out so logging them doesn't count.
+    memoryBefore = FPlatformMemory::GetStats().UsedPhysical;
+    startTime = FPlatformTime::Seconds();
+    int32 loadedExistingCount = 0;
+    for (const FString& blueprintPath : blueprintPaths) {
+        if (Cast<UBlueprint>(StaticLoadObject(UBlueprint::StaticClass(), nullptr, *blueprintPath, nullptr, LOAD_NoWarn | LOAD_Quiet)) != nullptr) {
+            loadedExistingCount++;
+        }
+    }
+    double loadSeconds = FPlatformTime::Seconds() - startTime;
+    int64 loadMemoryKb = ((int64)FPlatformMemory::GetStats().UsedPhysical - (int64)memoryBefore) / 1024;
+    int32 loadLoadedPackageCount = GetLoadedPackageNames().Difference(packagesBefore).Num();
+    TestEqual(TEXT("Both checks find the same blueprints"), loadedExistingCount, existingBlueprints.Num());
+
+    AddInfo(FString::Printf(TEXT("Checked %d mappings (%d exist). Asset registry: %.1f ms, %lld KB, %d packages loaded. Loading: %.1f ms, %lld KB, %d packages loaded."),
+        blueprintPaths.Num(), existingBlueprints.Num(),
+        registrySeconds * 1000.0, registryMemoryKb, registryLoadedPackageCount,
+        loadSeconds * 1000.0, loadMemoryKb, loadLoadedPackageCount));
+
+    UnloadPackagesExcept(packagesBefore);
+    return true;
+}
+
+#endif
@@ -0,0 +1,73 @@
+#include "CodeTemplate.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace {
+    const TArray<FString> TestPlaceholders = { TEXT("[WIDGET_NAME]"), TEXT("[WIDGET_SUFFIX]"), TEXT("[WIDGET_PATH]") };
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCodeTemplateRenderTest, "UmgControllerGenerator.CodeTemplate.Render",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCodeTemplateRenderTest::RunTest(const FString& parameters) {
+    FCodeTemplate codeTemplate;
+    codeTemplate.Compile(TEXT("[WIDGET_NAME][WIDGET_SUFFIX] loads [WIDGET_PATH] and uses [UNKNOWN] as is.\n[WIDGET_NAME]"), TestPlaceholders);
+
+    TArray<FStringView> values = { TEXT("MainMenu"), TEXT("Controller"), TEXT("/Game/UI/MainMenu") };
+    TestEqual(TEXT("Every placeholder is replaced, including adjacent ones and ones at either end"),
+        codeTemplate.Render(values), FString(TEXT("MainMenuController loads /Game/UI/MainMenu and uses [UNKNOWN] as is.\nMainMenu")));
+
+    TestTrue(TEXT("A placeholder in the template is found"), codeTemplate.HasPlaceholder(2));
+    TestFalse(TEXT("A slot that's out of range is never in the template"), codeTemplate.HasPlaceholder(3));
+
+    // A placeholder without a value renders as nothing
+    TArray<FStringView> fewerValues = { TEXT("MainMenu") };
+    TestEqual(TEXT("Missing values are left out"), codeTemplate.Render(fewerValues), FString(TEXT("MainMenu loads  and uses [UNKNOWN] as is.\nMainMenu")));
+
+    FCodeTemplate literalTemplate;
+    literalTemplate.Compile(TEXT("No placeholders [WIDGET_NAM] here"), TestPlaceholders);
+    TestFalse(TEXT("A partial placeholder is literal text"), literalTemplate.HasPlaceholder(0));
+    TestEqual(TEXT("A template without placeholders renders as is"), literalTemplate.Render(values), FString(TEXT("No placeholders [WIDGET_NAM] here")));
+
+    FCodeTemplate emptyTemplate;
+    emptyTemplate.Compile(FString(), TestPlaceholders);
+    TestTrue(TEXT("An empty template renders as nothing"), emptyTemplate.Render(values).IsEmpty());
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCodeTemplateFileTest, "UmgControllerGenerator.CodeTemplate.File",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCodeTemplateFileTest::RunTest(const FString& parameters) {
+    FString filePath = FPaths::CreateTempFilename(*FPaths::AutomationTransientDir(), TEXT("CodeTemplate"), TEXT(".h"));
+    if (!FFileHelper::SaveStringToFile(FString(TEXT("class U[WIDGET_NAME];")), *filePath)) {
+        AddError(FString::Printf(TEXT("Could not write %s"), *filePath));
+        return false;
+    }
+
+    FCodeTemplate codeTemplate;
+    TestTrue(TEXT("The template file is loaded"), codeTemplate.CompileFile(filePath, TestPlaceholders));
+    TestEqual(TEXT("The file's path is remembered"), codeTemplate.GetFilePath(), filePath);
+    TestFalse(TEXT("A file that was just loaded hasn't changed"), codeTemplate.IsFileChanged());
+
+    TArray<FStringView> values = { TEXT("MainMenu") };
+    TestEqual(TEXT("The file is rendered"), codeTemplate.Render(values), FString(TEXT("class UMainMenu;")));
+
+    // Editing the file changes its timestamp
+    IFileManager::Get().SetTimeStamp(*filePath, IFileManager::Get().GetTimeStamp(*filePath) + FTimespan::FromSeconds(10.0));
+    TestTrue(TEXT("A file with a new timestamp has changed"), codeTemplate.IsFileChanged());
+
+    // Compiling text directly forgets the file
+    codeTemplate.Compile(TEXT("[WIDGET_NAME]"), TestPlaceholders);
+    TestFalse(TEXT("A template compiled from text never changes"), codeTemplate.IsFileChanged());
+
+    IFileManager::Get().Delete(*filePath);
+    TestFalse(TEXT("A missing file can't be loaded"), codeTemplate.CompileFile(filePath, TestPlaceholders));
+    return true;
+}
+
+#endif
@@ -0,0 +1,98 @@
+#include "HeaderLookupTable.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/PackageName.h"
+#include "UObject/UObjectIterator.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHeaderLookupTableExactCasingTest, "UmgControllerGenerator.HeaderLookupTable.ExactCasing",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHeaderLookupTableExactCasingTest::RunTest(const FString& parameters) {
+    FHeaderIndexData index;
+    FName moduleName(TEXT("CasingTestModule"));
+
+    // The class name is created with different casing than the file so the name can't be used to rebuild the path
+    FName className(TEXT("UmgCasingTestWidget"));
+    FHeaderLookupEntry entry = index.MakeEntry(className, TEXT("Widgets/umgCasingTestWidget.h"), moduleName);
+    index.LookupTable.FindOrAdd(className).Add(entry);
+    TestEqual(TEXT("An include path keeps the casing of the file in the manifest"),
+        index.FindIncludePath(className, moduleName), FString(TEXT("Widgets/umgCasingTestWidget.h")));
+
+    // Files named exactly like their class don't need their name stored
+    FName matchingName(TEXT("UmgCasingTestPanel"));
+    FHeaderLookupEntry matchingEntry = index.MakeEntry(matchingName, TEXT("Widgets/UmgCasingTestPanel.h"), moduleName);
+    index.LookupTable.FindOrAdd(matchingName).Add(matchingEntry);
+    TestEqual(TEXT("A file named like its class is not pooled"), matchingEntry.FileNameId, (int32)INDEX_NONE);
+    TestEqual(TEXT("A file named like its class is rebuilt from the name"),
+        index.FindIncludePath(matchingName, NAME_None), FString(TEXT("Widgets/UmgCasingTestPanel.h")));
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHeaderLookupTableMemoryTest, "UmgControllerGenerator.HeaderLookupTable.MemoryUsage",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FHeaderLookupTableMemoryTest::RunTest(const FString& parameters) {
+#if WITH_EDITORONLY_DATA
+    // The include path of every native class in the editor is a realistic set of entries. They're
+    // stored the way the table used to store them and the way it stores them now.
+    static const FName includePathKey(TEXT("IncludePath"));
+    TMap<FString, FString> stringTable;
+    FHeaderIndexData index;
+    TMap<FName, FHeaderModuleIndex> moduleIndices;
+    for (TObjectIterator<UClass> classIt; classIt; ++classIt) {
+        UClass* nativeClass = *classIt;
+        // Only the first class with a name is kept since the string map can only hold one
+        if (!nativeClass->HasAnyClassFlags(CLASS_Native) || !nativeClass->HasMetaData(includePathKey) || index.LookupTable.Contains(nativeClass->GetFName())) {
+            continue;
+        }
+
+        const FString& includePath = nativeClass->GetMetaData(includePathKey);
+        FName moduleName(*FPackageName::GetShortName(nativeClass->GetOutermost()->GetName()));
+        stringTable.Add(nativeClass->GetName(), includePath);
+        index.LookupTable.FindOrAdd(nativeClass->GetFName()).Add(index.MakeEntry(nativeClass->GetFName(), includePath, moduleName));
+        moduleIndices.FindOrAdd(moduleName).ClassNames.Add(nativeClass->GetFName());
+    }
+
+    // Shrink the new one like the table does once it's built
+    index.LookupTable.Compact();
+    index.LookupTable.Shrink();
+    index.DirectoryPool.Shrink();
+    index.FileNamePool.Shrink();
+    moduleIndices.Shrink();
+
+    if (!TestTrue(TEXT("There are classes with an include path"), stringTable.Num() > 0)) {
+        return false;
+    }
+
+    // The map itself, its hash buckets and slack, plus the two strings in each entry
+    SIZE_T stringTableSize = stringTable.GetAllocatedSize();
+    for (const TPair<FString, FString>& entry : stringTable) {
+        stringTableSize += entry.Key.GetAllocatedSize() + entry.Value.GetAllocatedSize();
+    }
+
+    // Everything UHeaderLookupTable::GetAllocatedSize counts for a published index
+    SIZE_T indexSize = index.GetAllocatedSize() + moduleIndices.GetAllocatedSize();
+    for (const TPair<FName, FHeaderModuleIndex>& moduleIndex : moduleIndices) {
+        indexSize += moduleIndex.Value.ClassNames.GetAllocatedSize();
+    }
+
+    for (const TPair<FString, FString>& entry : stringTable) {
+        FName className(*entry.Key);
+        if (index.FindIncludePath(className, NAME_None) != entry.Value) {
+            AddError(FString::Printf(TEXT("%s is included from %s instead of %s"), *entry.Key, *index.FindIncludePath(className, NAME_None), *entry.Value));
+            break;
+        }
+    }
+
+    // Neither size counts what the allocator adds to each allocation. The string map makes two per entry.
+    AddInfo(FString::Printf(TEXT("%d classes in %d directories. TMap<FString, FString>: %.1f KB in %d allocations. Header lookup table: %.1f KB (%.0f%%)."),
+        stringTable.Num(), index.DirectoryPool.Num(), stringTableSize / 1024.0, stringTable.Num() * 2 + 2,
+        indexSize / 1024.0, 100.0 * indexSize / stringTableSize));
+    TestTrue(TEXT("The header lookup table is smaller than a string map of the same entries"), indexSize < stringTableSize);
+#endif
+    return true;
+}
+
+#endif
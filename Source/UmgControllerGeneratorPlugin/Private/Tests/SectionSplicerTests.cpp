@@ -0,0 +1,175 @@
+#include "SectionSplicer.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace {
+    const TCHAR* PropertiesPrefix = TEXT("// ---------- Generated Properties Section ---------- //\n//              (Don't modify manually)               //");
+    const TCHAR* PropertiesSuffix = TEXT("// ---------- End Generated Properties Section ---------- //");
+    const TCHAR* LoaderPrefix = TEXT("// ---------- Generated Loader Section ---------- //\n//             (Don't modify manually)            //");
+    const TCHAR* LoaderSuffix = TEXT("// ---------- End Generated Loader Section ---------- //");
+
+    /**
+     * Makes a splicer with the default header sections. Properties is section 0 and loader is section 1.
+     */
+    FSectionSplicer MakeHeaderSplicer() {
+        FSectionSplicer splicer;
+        splicer.AddSection(TEXT("properties"), PropertiesPrefix, PropertiesSuffix);
+        splicer.AddSection(TEXT("loader"), LoaderPrefix, LoaderSuffix);
+        return splicer;
+    }
+
+    /**
+     * Builds a controller header with the given number of generated properties and hand-written methods around them.
+     */
+    FString MakeControllerHeader(int32 propertyCount, int32 handWrittenMethodCount) {
+        FString contents = TEXT("#pragma once\n\n#include \"CoreMinimal.h\"\n#include \"Blueprint/UserWidget.h\"\n#include \"BenchmarkController.generated.h\"\n\n");
+        contents += TEXT("UCLASS()\nclass UBenchmarkController : public UUserWidget {\n    GENERATED_BODY()\n\npublic: // Methods\n");
+        for (int32 index = 0; index < handWrittenMethodCount; index++) {
+            contents += FString::Printf(TEXT("    // Handles the [%d] event. Keep this in sync with the designer's notes.\n    void OnSomethingHappened%d(int32 value, const FString& reason);\n\n"), index, index);
+        }
+
+        contents += TEXT("public: // Properties\n");
+        contents += PropertiesPrefix;
+        contents += TEXT("\n");
+        for (int32 index = 0; index < propertyCount; index++) {
+            contents += FString::Printf(TEXT("    UPROPERTY(BlueprintReadOnly, meta = (BindWidget))\n    class UTextBlock* Label%d = nullptr;\n\n"), index);
+        }
+        contents += PropertiesSuffix;
+        contents += TEXT("\n};\n\n");
+
+        contents += LoaderPrefix;
+        contents += TEXT("\nUCLASS()\nclass UBenchmarkLoader : public UObject {\n    GENERATED_BODY()\n};\n");
+        contents += LoaderSuffix;
+        contents += TEXT("\n");
+        return contents;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSectionSplicerFindTest, "UmgControllerGenerator.SectionSplicer.FindSections",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSectionSplicerFindTest::RunTest(const FString& parameters) {
+    FSectionSplicer splicer = MakeHeaderSplicer();
+    FString contents = MakeControllerHeader(2, 1);
+
+    FSectionLayout layout;
+    FString error;
+    TestTrue(TEXT("A well formed file is accepted"), splicer.FindSections(contents, layout, error));
+    TestTrue(TEXT("The properties section is found"), layout.HasSection(0));
+    TestTrue(TEXT("The loader section is found"), layout.HasSection(1));
+    TestTrue(TEXT("The body is what's between the markers"), layout.GetBody(0).StartsWith(TEXT("\n    UPROPERTY(")));
+
+    // Splicing every body back in as it was gives the same file
+    FString spliced;
+    splicer.Splice(layout, spliced, 0, [] (int32 sectionId, FStringView body, FString& output) { output.Append(body.GetData(), body.Len()); });
+    TestEqual(TEXT("An unchanged splice is the original file"), spliced, contents);
+
+    // A file without any sections isn't an error
+    TestTrue(TEXT("A file without sections is accepted"), splicer.FindSections(TEXT("#pragma once\n"), layout, error));
+    TestFalse(TEXT("Nothing is found in a file without sections"), layout.HasSection(0) || layout.HasSection(1));
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSectionSplicerCrlfTest, "UmgControllerGenerator.SectionSplicer.Crlf",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSectionSplicerCrlfTest::RunTest(const FString& parameters) {
+    // The markers have '\n' in them so use single line ones like a project with CRLF markers would
+    FSectionSplicer splicer;
+    splicer.AddSection(TEXT("properties"), TEXT("// BEGIN PROPERTIES"), TEXT("// END PROPERTIES"));
+    FString contents = TEXT("class A {\r\n// BEGIN PROPERTIES\r\n    int32 Value;\r\n// END PROPERTIES\r\n};\r\n");
+
+    FSectionLayout layout;
+    FString error;
+    TestTrue(TEXT("A file with CRLF line breaks is accepted"), splicer.FindSections(contents, layout, error));
+    TestEqual(TEXT("The CRLF after the suffix belongs to the section"), layout.Sections[0].End, contents.Find(TEXT("};")));
+
+    FString spliced;
+    splicer.Splice(layout, spliced, 0, [] (int32 sectionId, FStringView body, FString& output) { output += TEXT("\r\n    int32 Other;\r\n"); });
+    TestEqual(TEXT("Everything outside the body keeps its line breaks"), spliced, FString(TEXT("class A {\r\n// BEGIN PROPERTIES\r\n    int32 Other;\r\n// END PROPERTIES\r\n};\r\n")));
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSectionSplicerErrorsTest, "UmgControllerGenerator.SectionSplicer.Errors",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSectionSplicerErrorsTest::RunTest(const FString& parameters) {
+    FSectionSplicer splicer = MakeHeaderSplicer();
+    FString properties = FString(PropertiesPrefix) + TEXT("\n") + PropertiesSuffix + TEXT("\n");
+    FString loader = FString(LoaderPrefix) + TEXT("\n") + LoaderSuffix + TEXT("\n");
+
+    auto expectError = [this, &splicer] (const TCHAR* description, const FString& contents, const TCHAR* expectedError) {
+        FSectionLayout layout;
+        FString error;
+        TestFalse(description, splicer.FindSections(contents, layout, error));
+        TestTrue(FString::Printf(TEXT("%s: \"%s\" mentions \"%s\""), description, *error, expectedError), error.Contains(expectedError));
+    };
+
+    expectError(TEXT("A duplicate section"), properties + TEXT("\n") + properties, TEXT("starts again on line 5"));
+    expectError(TEXT("A duplicate suffix"), properties + PropertiesSuffix + TEXT("\n"), TEXT("ends again on line 4"));
+    expectError(TEXT("An unterminated section"), FString(TEXT("\n")) + PropertiesPrefix + TEXT("\n"), TEXT("started on line 2 never ends"));
+    expectError(TEXT("A nested section"), FString(PropertiesPrefix) + TEXT("\n") + loader + PropertiesSuffix, TEXT("loader section starts inside the properties section"));
+    expectError(TEXT("A suffix before its prefix"), FString(PropertiesSuffix) + TEXT("\n") + properties, TEXT("ends on line 1 but was never started"));
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSectionSplicerBenchmark, "UmgControllerGenerator.SectionSplicer.Benchmark",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FSectionSplicerBenchmark::RunTest(const FString& parameters) {
+    // A large controller where most of the file is hand-written code the splice has to copy
+    FSectionSplicer splicer = MakeHeaderSplicer();
+    FString contents = MakeControllerHeader(500, 2000);
+    FString newProperties = FString::Printf(TEXT("\n%s"), *FString::ChrN(64 * 1024, TEXT('x')));
+    const int32 iterationCount = 200;
+
+    double startTime = FPlatformTime::Seconds();
+    int32 totalLength = 0;
+    for (int32 iteration = 0; iteration < iterationCount; iteration++) {
+        FSectionLayout layout;
+        FString error;
+        if (!splicer.FindSections(contents, layout, error)) {
+            AddError(error);
+            return false;
+        }
+
+        FString spliced;
+        splicer.Splice(layout, spliced, newProperties.Len(), [&newProperties] (int32 sectionId, FStringView body, FString& output) {
+            if (sectionId == 0) {
+                output += newProperties;
+            } else {
+                output.Append(body.GetData(), body.Len());
+            }
+        });
+        totalLength += spliced.Len();
+    }
+    double spliceSeconds = FPlatformTime::Seconds() - startTime;
+
+    // The way it used to be done: a search for each marker and a copy for each piece
+    startTime = FPlatformTime::Seconds();
+    for (int32 iteration = 0; iteration < iterationCount; iteration++) {
+        FString spliced = contents;
+        int32 prefixIndex = spliced.Find(PropertiesPrefix, ESearchCase::CaseSensitive);
+        int32 suffixIndex = spliced.Find(PropertiesSuffix, ESearchCase::CaseSensitive);
+        int32 bodyStart = prefixIndex + FCString::Strlen(PropertiesPrefix);
+        spliced = spliced.Left(bodyStart) + newProperties + spliced.RightChop(suffixIndex);
+
+        prefixIndex = spliced.Find(LoaderPrefix, ESearchCase::CaseSensitive);
+        suffixIndex = spliced.Find(LoaderSuffix, ESearchCase::CaseSensitive);
+        bodyStart = prefixIndex + FCString::Strlen(LoaderPrefix);
+        spliced = spliced.Left(bodyStart) + spliced.Mid(bodyStart, suffixIndex - bodyStart) + spliced.RightChop(suffixIndex);
+        totalLength -= spliced.Len();
+    }
+    double searchAndCopySeconds = FPlatformTime::Seconds() - startTime;
+
+    TestEqual(TEXT("Both ways produce files of the same length"), totalLength, 0);
+    double megabytes = (double)contents.Len() * sizeof(TCHAR) * iterationCount / (1024.0 * 1024.0);
+    AddInfo(FString::Printf(TEXT("Spliced a %d KB controller %d times in %.1f ms (%.0f MB/s). Search and copy took %.1f ms (%.0f MB/s)."),
+        contents.Len() * (int32)sizeof(TCHAR) / 1024, iterationCount,
+        spliceSeconds * 1000.0, spliceSeconds > 0.0 ? megabytes / spliceSeconds : 0.0,
+        searchAndCopySeconds * 1000.0, searchAndCopySeconds > 0.0 ? megabytes / searchAndCopySeconds : 0.0));
+    return true;
+}
+
+#endif
@@ -0,0 +1,125 @@
+#include "SourceFile.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace {
+    // Has a character outside ASCII so the encodings are actually different
+    const TCHAR* TestContents = TEXT("#pragma once\n\n// Caf\u00e9 menu controller\nclass UCafeMenuController;\n");
+
+    /**
+     * Encodes the text by hand so the test doesn't depend on how FSourceFile does it.
+     */
+    TArray<uint8> MakeFileBytes(const FString& contents, ESourceFileEncoding encoding, bool usesCrlf, bool bigEndian = false) {
+        FString text = usesCrlf ? contents.Replace(TEXT("\n"), TEXT("\r\n")) : contents;
+        TArray<uint8> bytes;
+        if (encoding == ESourceFileEncoding::Utf16LittleEndian) {
+            FTCHARToUTF16 converter(*text, text.Len());
+            bytes.Append(bigEndian ? TArray<uint8>({ 0xFE, 0xFF }) : TArray<uint8>({ 0xFF, 0xFE }));
+            for (int32 index = 0; index < converter.Length(); index++) {
+                uint8 low = converter.Get()[index] & 0xFF;
+                uint8 high = (converter.Get()[index] >> 8) & 0xFF;
+                bytes.Add(bigEndian ? high : low);
+                bytes.Add(bigEndian ? low : high);
+            }
+        } else {
+            if (encoding == ESourceFileEncoding::Utf8WithBom) {
+                bytes.Append({ 0xEF, 0xBB, 0xBF });
+            }
+            FTCHARToUTF8 converter(*text, text.Len());
+            bytes.Append(reinterpret_cast<const uint8*>(converter.Get()), converter.Length());
+        }
+        return bytes;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSourceFileRoundTripTest, "UmgControllerGenerator.SourceFile.RoundTrip",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSourceFileRoundTripTest::RunTest(const FString& parameters) {
+    const ESourceFileEncoding encodings[] = { ESourceFileEncoding::Utf8, ESourceFileEncoding::Utf8WithBom, ESourceFileEncoding::Utf16LittleEndian };
+    const TCHAR* encodingNames[] = { TEXT("UTF-8"), TEXT("UTF-8 with a BOM"), TEXT("UTF-16") };
+    FString filePath = FPaths::CreateTempFilename(*FPaths::AutomationTransientDir(), TEXT("SourceFile"), TEXT(".h"));
+
+    for (int32 encodingIndex = 0; encodingIndex < UE_ARRAY_COUNT(encodings); encodingIndex++) {
+        for (bool usesCrlf : { false, true }) {
+            FString description = FString::Printf(TEXT("%s with %s"), encodingNames[encodingIndex], usesCrlf ? TEXT("CRLF") : TEXT("LF"));
+            TArray<uint8> fileBytes = MakeFileBytes(TestContents, encodings[encodingIndex], usesCrlf);
+            if (!FFileHelper::SaveArrayToFile(fileBytes, *filePath)) {
+                AddError(FString::Printf(TEXT("Could not write %s"), *filePath));
+                return false;
+            }
+
+            FSourceFile sourceFile;
+            if (!TestTrue(description + TEXT(" is loaded"), sourceFile.Load(filePath))) {
+                continue;
+            }
+            TestEqual(description + TEXT(" has its encoding detected"), (uint8)sourceFile.Encoding, (uint8)encodings[encodingIndex]);
+            TestEqual(description + TEXT(" has its line breaks detected"), sourceFile.UsesCrlf, usesCrlf);
+            TestEqual(description + TEXT(" is decoded with '\\n' line breaks"), sourceFile.Contents, FString(TestContents));
+
+            // Saving what was loaded leaves the file alone
+            bool wasWritten = true;
+            TestTrue(description + TEXT(" is already saved"), sourceFile.IsSavedAt(filePath));
+            TestTrue(description + TEXT(" saves when nothing changed"), sourceFile.Save(filePath, wasWritten));
+            TestFalse(description + TEXT(" isn't written when nothing changed"), wasWritten);
+
+            // Changes are written back the way the file was
+            sourceFile.Contents += TEXT("class UOtherController;\n");
+            TestFalse(description + TEXT(" with changes isn't saved yet"), sourceFile.IsSavedAt(filePath));
+            TestTrue(description + TEXT(" saves its changes"), sourceFile.Save(filePath, wasWritten));
+            TestTrue(description + TEXT(" is written when it changed"), wasWritten);
+
+            TArray<uint8> savedBytes;
+            FFileHelper::LoadFileToArray(savedBytes, *filePath);
+            TestTrue(description + TEXT(" keeps its encoding and line breaks"),
+                savedBytes == MakeFileBytes(FString(TestContents) + TEXT("class UOtherController;\n"), encodings[encodingIndex], usesCrlf));
+            TestTrue(description + TEXT(" is saved after writing"), sourceFile.IsSavedAt(filePath));
+        }
+    }
+
+    // A file that didn't exist is written
+    IFileManager::Get().Delete(*filePath);
+    FSourceFile newFile;
+    newFile.SetContents(TEXT("// New\r\n"));
+    bool wasWritten = false;
+    TestTrue(TEXT("The line breaks of the text that's set are used"), newFile.UsesCrlf);
+    TestFalse(TEXT("A missing file isn't saved"), newFile.IsSavedAt(filePath));
+    TestTrue(TEXT("A missing file is saved"), newFile.Save(filePath, wasWritten));
+    TestTrue(TEXT("A missing file is written"), wasWritten);
+
+    IFileManager::Get().Delete(*filePath);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSourceFileBigEndianTest, "UmgControllerGenerator.SourceFile.BigEndian",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSourceFileBigEndianTest::RunTest(const FString& parameters) {
+    FString filePath = FPaths::CreateTempFilename(*FPaths::AutomationTransientDir(), TEXT("SourceFile"), TEXT(".h"));
+    if (!FFileHelper::SaveArrayToFile(MakeFileBytes(TestContents, ESourceFileEncoding::Utf16LittleEndian, false, true), *filePath)) {
+        AddError(FString::Printf(TEXT("Could not write %s"), *filePath));
+        return false;
+    }
+
+    FSourceFile sourceFile;
+    TestTrue(TEXT("A big endian file is loaded"), sourceFile.Load(filePath));
+    TestEqual(TEXT("A big endian file is decoded"), sourceFile.Contents, FString(TestContents));
+
+    // Big endian files are written back as little endian
+    bool wasWritten = false;
+    TestTrue(TEXT("A big endian file is saved"), sourceFile.Save(filePath, wasWritten));
+    TestTrue(TEXT("A big endian file is rewritten"), wasWritten);
+
+    TArray<uint8> savedBytes;
+    FFileHelper::LoadFileToArray(savedBytes, *filePath);
+    TestTrue(TEXT("A big endian file is saved as little endian"), savedBytes == MakeFileBytes(TestContents, ESourceFileEncoding::Utf16LittleEndian, false));
+
+    IFileManager::Get().Delete(*filePath);
+    return true;
+}
+
+#endif
@@ -0,0 +1,116 @@
+#include "UhtManifestReader.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace {
+    // Two modules with the fields UHT writes that the reader skips, escaped paths and a BOM in front
+    const TCHAR* TestManifest = TEXT("\uFEFF{\n")
+        TEXT("  \"IsGameTarget\": true,\n")
+        TEXT("  \"RootLocalPath\": \"C:\\\\Projects\\\\Game\",\n")
+        TEXT("  \"TargetName\": \"GameEditor\",\n")
+        TEXT("  \"Modules\": [\n")
+        TEXT("    {\n")
+        TEXT("      \"Name\": \"Game\",\n")
+        TEXT("      \"ModuleType\": \"GameRuntime\",\n")
+        TEXT("      \"OverrideModuleType\": \"None\",\n")
+        TEXT("      \"BaseDirectory\": \"C:\\\\Projects\\\\Game\\\\Source\\\\Game\",\n")
+        TEXT("      \"IncludeBase\": \"C:\\\\Projects\\\\Game\\\\Source\",\n")
+        TEXT("      \"OutputDirectory\": \"C:\\\\Projects\\\\Game\\\\Intermediate\",\n")
+        TEXT("      \"ClassesHeaders\": [],\n")
+        TEXT("      \"PublicHeaders\": [ \"C:\\\\Projects\\\\Game\\\\Source\\\\Game\\\\Public\\\\MainMenu.h\", \"C:\\\\Projects\\\\Game\\\\Source\\\\Game\\\\Public\\\\Caf\\u00e9.h\" ],\n")
+        TEXT("      \"InternalHeaders\": null,\n")
+        TEXT("      \"PrivateHeaders\": [ \"C:\\\\Projects\\\\Game\\\\Source\\\\Game\\\\Private\\\\Hud.h\" ],\n")
+        TEXT("      \"GeneratedCPPFilenameBase\": \"C:\\\\Projects\\\\Game\\\\Intermediate\\\\Game.gen\",\n")
+        TEXT("      \"SaveExportedHeaders\": true,\n")
+        TEXT("      \"UHTGeneratedCodeVersion\": \"None\",\n")
+        TEXT("      \"VersePath\": { \"Nested\": [ 1, 2.5, { \"Deeper\": false } ] }\n")
+        TEXT("    },\n")
+        TEXT("    { \"Name\": \"GameUI\", \"BaseDirectory\": \"/home/build/Game/Source/GameUI\", \"PublicHeaders\": [], \"InternalHeaders\": [ \"/home/build/Game/Source/GameUI/Internal/Menu.h\" ], \"PrivateHeaders\": [] }\n")
+        TEXT("  ],\n")
+        TEXT("  \"UhtPlugins\": []\n")
+        TEXT("}\n");
+
+    TArray<uint8> ToUtf8(const FString& text) {
+        FTCHARToUTF8 converter(*text, text.Len());
+        return TArray<uint8>(reinterpret_cast<const uint8*>(converter.Get()), converter.Length());
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUhtManifestReaderReadTest, "UmgControllerGenerator.UhtManifestReader.ReadModules",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FUhtManifestReaderReadTest::RunTest(const FString& parameters) {
+    TArray<uint8> manifestBytes = ToUtf8(TestManifest);
+    TArray<FUhtModuleHeaders> modules;
+    if (!TestTrue(TEXT("The manifest is read"), FUhtManifestReader::ReadModules(MakeMemoryView(manifestBytes), modules))) {
+        return false;
+    }
+    if (!TestEqual(TEXT("Both modules are read"), modules.Num(), 2)) {
+        return false;
+    }
+
+    const FUhtModuleHeaders& game = modules[0];
+    TestEqual(TEXT("The first module is first"), game.Name, FString(TEXT("Game")));
+    TestEqual(TEXT("Escaped backslashes are decoded"), game.BaseDirectory, FString(TEXT("C:\\Projects\\Game\\Source\\Game")));
+    TestEqual(TEXT("Every public header is read"), game.PublicHeaders.Num(), 2);
+    if (game.PublicHeaders.Num() == 2) {
+        TestEqual(TEXT("Unicode escapes are decoded"), game.PublicHeaders[1], FString(TEXT("C:\\Projects\\Game\\Source\\Game\\Public\\Caf\u00e9.h")));
+    }
+    TestEqual(TEXT("A null header list is empty"), game.InternalHeaders.Num(), 0);
+    TestEqual(TEXT("Private headers are read"), game.PrivateHeaders.Num(), 1);
+
+    const FUhtModuleHeaders& gameUi = modules[1];
+    TestEqual(TEXT("The second module is second"), gameUi.Name, FString(TEXT("GameUI")));
+    TestEqual(TEXT("Internal headers are read"), gameUi.InternalHeaders.Num(), 1);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUhtManifestReaderFindTest, "UmgControllerGenerator.UhtManifestReader.FindModules",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FUhtManifestReaderFindTest::RunTest(const FString& parameters) {
+    TArray<uint8> manifestBytes = ToUtf8(TestManifest);
+    FMemoryView manifestView = MakeMemoryView(manifestBytes);
+    TArray<FUhtModuleLocation> locations;
+    if (!TestTrue(TEXT("The modules are found"), FUhtManifestReader::FindModules(manifestView, locations)) || !TestEqual(TEXT("Both modules are found"), locations.Num(), 2)) {
+        return false;
+    }
+
+    // Each location can be read on its own the way lazy indexing does
+    for (int32 index = 0; index < locations.Num(); index++) {
+        const FUhtModuleLocation& location = locations[index];
+        TestEqual(TEXT("Modules are in manifest order"), location.Order, index);
+
+        FUhtModuleHeaders moduleHeaders;
+        TestTrue(TEXT("A module is read from its location"), FUhtManifestReader::ReadModule(manifestView.Mid(location.Offset, location.Size), moduleHeaders));
+        TestEqual(TEXT("The module read from a location has the name that was found"), moduleHeaders.Name, location.Name);
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUhtManifestReaderErrorsTest, "UmgControllerGenerator.UhtManifestReader.Errors",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FUhtManifestReaderErrorsTest::RunTest(const FString& parameters) {
+    // The reader logs each failure as an error
+    AddExpectedError(TEXT("could not be read"), EAutomationExpectedErrorFlags::Contains, 3);
+    AddExpectedError(TEXT("does not start with a JSON object"), EAutomationExpectedErrorFlags::Contains, 1);
+
+    TArray<FUhtModuleHeaders> modules;
+    TArray<uint8> noModules = ToUtf8(TEXT("{ \"TargetName\": \"GameEditor\" }"));
+    TestFalse(TEXT("A manifest without modules is rejected"), FUhtManifestReader::ReadModules(MakeMemoryView(noModules), modules));
+
+    FString manifest = TestManifest;
+    TArray<uint8> truncated = ToUtf8(manifest.Left(manifest.Len() / 2));
+    TestFalse(TEXT("A truncated manifest is rejected"), FUhtManifestReader::ReadModules(MakeMemoryView(truncated), modules));
+
+    TArray<uint8> badModule = ToUtf8(TEXT("{ \"Modules\": [ { \"Name\" \"Game\" } ] }"));
+    TestFalse(TEXT("A malformed module is rejected"), FUhtManifestReader::ReadModules(MakeMemoryView(badModule), modules));
+
+    TArray<uint8> notAnObject = ToUtf8(TEXT("[ \"Modules\" ]"));
+    TestFalse(TEXT("A manifest that isn't an object is rejected"), FUhtManifestReader::ReadModules(MakeMemoryView(notAnObject), modules));
+    return true;
+}
+
+#endif
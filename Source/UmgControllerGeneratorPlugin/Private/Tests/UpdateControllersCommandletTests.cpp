@@ -0,0 +1,63 @@
+#include "UpdateControllersCommandlet.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUpdateControllersParseShardTest, "UmgControllerGenerator.UpdateControllersCommandlet.ParseShard",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FUpdateControllersParseShardTest::RunTest(const FString& parameters) {
+    int32 shardIndex = 0;
+    int32 shardCount = 0;
+    TestTrue(TEXT("A shard in range is accepted"), UUpdateControllersCommandlet::ParseShard(TEXT("3/8"), shardIndex, shardCount));
+    TestEqual(TEXT("The index is read"), shardIndex, 3);
+    TestEqual(TEXT("The count is read"), shardCount, 8);
+    TestTrue(TEXT("The last shard is accepted"), UUpdateControllersCommandlet::ParseShard(TEXT("8/8"), shardIndex, shardCount));
+    TestTrue(TEXT("A single shard is accepted"), UUpdateControllersCommandlet::ParseShard(TEXT("1/1"), shardIndex, shardCount));
+
+    const TCHAR* invalidShards[] = { TEXT("0/8"), TEXT("9/8"), TEXT("-1/8"), TEXT("1/0"), TEXT("a/b"), TEXT("3/b"), TEXT("8"), TEXT("/8"), TEXT("3/"), TEXT("") };
+    for (const TCHAR* shardSpec : invalidShards) {
+        TestFalse(FString::Printf(TEXT("\"%s\" is rejected"), shardSpec), UUpdateControllersCommandlet::ParseShard(shardSpec, shardIndex, shardCount));
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUpdateControllersIsInShardTest, "UmgControllerGenerator.UpdateControllersCommandlet.IsInShard",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FUpdateControllersIsInShardTest::RunTest(const FString& parameters) {
+    const int32 shardCount = 8;
+    TArray<int32> blueprintsPerShard;
+    blueprintsPerShard.SetNumZeroed(shardCount);
+
+    for (int32 pathIndex = 0; pathIndex < 1000; pathIndex++) {
+        FString blueprintPath = FString::Printf(TEXT("/Game/UI/Menu%d/WBP_Menu%d.WBP_Menu%d"), pathIndex % 10, pathIndex, pathIndex);
+        int32 shardsContainingPath = 0;
+        for (int32 shardIndex = 1; shardIndex <= shardCount; shardIndex++) {
+            if (UUpdateControllersCommandlet::IsInShard(blueprintPath, shardIndex, shardCount)) {
+                shardsContainingPath++;
+                blueprintsPerShard[shardIndex - 1]++;
+            }
+        }
+
+        if (shardsContainingPath != 1) {
+            AddError(FString::Printf(TEXT("%s is in %d shards instead of one"), *blueprintPath, shardsContainingPath));
+        }
+    }
+
+    // The hash isn't random, but it shouldn't leave any shard empty either
+    for (int32 shardIndex = 0; shardIndex < shardCount; shardIndex++) {
+        TestTrue(FString::Printf(TEXT("Shard %d of %d has blueprints"), shardIndex + 1, shardCount), blueprintsPerShard[shardIndex] > 0);
+    }
+
+    // The shards are the CRC32 of the UTF-8 path so these have to stay put for shards on different machines to agree
+    TestTrue(TEXT("The main menu stays in its shard"), UUpdateControllersCommandlet::IsInShard(TEXT("/Game/UI/MainMenu.MainMenu"), 4, shardCount));
+    TestTrue(TEXT("The pause menu stays in its shard"), UUpdateControllersCommandlet::IsInShard(TEXT("/Game/UI/PauseMenu.PauseMenu"), 2, shardCount));
+    TestTrue(TEXT("The options menu stays in its shard"), UUpdateControllersCommandlet::IsInShard(TEXT("/Game/UI/Options.Options"), 1, shardCount));
+
+    // A single shard has everything
+    TestTrue(TEXT("Every blueprint is in the only shard"), UUpdateControllersCommandlet::IsInShard(TEXT("/Game/UI/MainMenu.MainMenu"), 1, 1));
+    return true;
+}
+
+#endif
@@ -0,0 +1,432 @@
+#include "UhtManifestReader.h"
+#include "Async/ParallelFor.h"
+#include "Containers/StringConv.h"
+#include <atomic>
+
+DEFINE_LOG_CATEGORY_STATIC(UhtManifestReaderSub, Log, All)
+
+namespace {
+    /**
+     * A minimal forward-only JSON scanner over UTF-8 text. It only
+     * decodes the values that are asked for and skips everything else.
+     */
+    class FJsonScanner {
+    public:
+        FJsonScanner(const ANSICHAR* begin, const ANSICHAR* end) : _current(begin), _end(end) { }
+
+        bool HasError() const { return _hasError; }
+        const ANSICHAR* GetPosition() const { return _current; }
+
+        void SkipWhitespace() {
+            while (_current < _end && (*_current == ' ' || *_current == '\t' || *_current == '\r' || *_current == '\n')) {
+                _current++;
+            }
+        }
+
+        ANSICHAR Peek() {
+            SkipWhitespace();
+            return _current < _end ? *_current : '\0';
+        }
+
+        bool Consume(ANSICHAR expected) {
+            if (Peek() != expected) {
+                _hasError = true;
+                return false;
+            }
+            _current++;
+            return true;
+        }
+
+        /**
+         * Reads the raw text of a string without decoding escapes. Used for object keys.
+         */
+        bool ReadKey(FAnsiStringView& outKey) {
+            if (!Consume('"')) {
+                return false;
+            }
+
+            const ANSICHAR* start = _current;
+            while (_current < _end && *_current != '"') {
+                if (*_current == '\\') {
+                    _current++;
+                }
+                _current++;
+            }
+            if (_current >= _end) {
+                _hasError = true;
+                return false;
+            }
+
+            outKey = FAnsiStringView(start, (int32)(_current - start));
+            _current++;
+            return Consume(':');
+        }
+
+        /**
+         * Reads a string value. If the value is not a string (null for example) it is skipped.
+         */
+        bool ReadString(FString& outValue) {
+            if (Peek() != '"') {
+                return SkipValue();
+            }
+            _current++;
+
+            // Most strings have no escapes so they can be converted straight from the source
+            const ANSICHAR* start = _current;
+            bool hasEscapes = false;
+            while (_current < _end && *_current != '"') {
+                if (*_current == '\\') {
+                    hasEscapes = true;
+                    _current++;
+                }
+                _current++;
+            }
+            if (_current >= _end) {
+                _hasError = true;
+                return false;
+            }
+            const ANSICHAR* stringEnd = _current;
+            _current++;
+
+            if (!hasEscapes) {
+                FUTF8ToTCHAR converted(start, (int32)(stringEnd - start));
+                outValue = FString(converted.Length(), converted.Get());
+                return true;
+            }
+
+            TArray<ANSICHAR, TInlineAllocator<512>> decoded;
+            decoded.Reserve((int32)(stringEnd - start));
+            for (const ANSICHAR* c = start; c < stringEnd; c++) {
+                if (*c != '\\') {
+                    decoded.Add(*c);
+                    continue;
+                }
+
+                c++;
+                switch (*c) {
+                    case 'b': decoded.Add('\b'); break;
+                    case 'f': decoded.Add('\f'); break;
+                    case 'n': decoded.Add('\n'); break;
+                    case 'r': decoded.Add('\r'); break;
+                    case 't': decoded.Add('\t'); break;
+                    case 'u': {
+                        uint32 codePoint = 0;
+                        if (!ReadHex4(c + 1, stringEnd, codePoint)) {
+                            _hasError = true;
+                            return false;
+                        }
+                        c += 4;
+
+                        // Combine surrogate pairs
+                        if (codePoint >= 0xD800 && codePoint <= 0xDBFF && c + 6 < stringEnd && c[1] == '\\' && c[2] == 'u') {
+                            uint32 lowSurrogate = 0;
+                            if (ReadHex4(c + 3, stringEnd, lowSurrogate) && lowSurrogate >= 0xDC00 && lowSurrogate <= 0xDFFF) {
+                                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                                c += 6;
+                            }
+                        }
+                        AppendUtf8(decoded, codePoint);
+                        break;
+                    }
+                    default: decoded.Add(*c); break; // \" \\ and \/
+                }
+            }
+
+            FUTF8ToTCHAR converted(decoded.GetData(), decoded.Num());
+            outValue = FString(converted.Length(), converted.Get());
+            return true;
+        }
+
+        bool ReadStringArray(TArray<FString>& outValues) {
+            if (Peek() != '[') {
+                return SkipValue();
+            }
+            _current++;
+
+            if (Peek() == ']') {
+                _current++;
+                return true;
+            }
+
+            while (!_hasError) {
+                FString& value = outValues.AddDefaulted_GetRef();
+                if (!ReadString(value)) {
+                    return false;
+                }
+
+                ANSICHAR next = Peek();
+                _current++;
+                if (next == ']') {
+                    return true;
+                } else if (next != ',') {
+                    _hasError = true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * Skips over the next value of any type.
+         */
+        bool SkipValue() {
+            ANSICHAR first = Peek();
+            if (first == '"') {
+                _current++;
+                while (_current < _end && *_current != '"') {
+                    if (*_current == '\\') {
+                        _current++;
+                    }
+                    _current++;
+                }
+                if (_current >= _end) {
+                    _hasError = true;
+                    return false;
+                }
+                _current++;
+                return true;
+            }
+
+            if (first == '{' || first == '[') {
+                ANSICHAR closing = first == '{' ? '}' : ']';
+                _current++;
+                if (Peek() == closing) {
+                    _current++;
+                    return true;
+                }
+
+                while (!_hasError) {
+                    if (first == '{') {
+                        FAnsiStringView key;
+                        if (!ReadKey(key)) {
+                            return false;
+                        }
+                    }
+                    if (!SkipValue()) {
+                        return false;
+                    }
+
+                    ANSICHAR next = Peek();
+                    _current++;
+                    if (next == closing) {
+                        return true;
+                    } else if (next != ',') {
+                        _hasError = true;
+                    }
+                }
+                return false;
+            }
+
+            // Numbers, true, false and null
+            const ANSICHAR* start = _current;
+            while (_current < _end && *_current != ',' && *_current != '}' && *_current != ']'
+                    && *_current != ' ' && *_current != '\t' && *_current != '\r' && *_current != '\n') {
+                _current++;
+            }
+            if (_current == start) {
+                _hasError = true;
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        static bool ReadHex4(const ANSICHAR* start, const ANSICHAR* end, uint32& outValue) {
+            if (end - start < 4) {
+                return false;
+            }
+
+            outValue = 0;
+            for (int32 i = 0; i < 4; i++) {
+                ANSICHAR c = start[i];
+                outValue <<= 4;
+                if (c >= '0' && c <= '9') outValue |= c - '0';
+                else if (c >= 'a' && c <= 'f') outValue |= c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F') outValue |= c - 'A' + 10;
+                else return false;
+            }
+            return true;
+        }
+
+        template <typename AllocatorType>
+        static void AppendUtf8(TArray<ANSICHAR, AllocatorType>& output, uint32 codePoint) {
+            if (codePoint < 0x80) {
+                output.Add((ANSICHAR)codePoint);
+            } else if (codePoint < 0x800) {
+                output.Add((ANSICHAR)(0xC0 | (codePoint >> 6)));
+                output.Add((ANSICHAR)(0x80 | (codePoint & 0x3F)));
+            } else if (codePoint < 0x10000) {
+                output.Add((ANSICHAR)(0xE0 | (codePoint >> 12)));
+                output.Add((ANSICHAR)(0x80 | ((codePoint >> 6) & 0x3F)));
+                output.Add((ANSICHAR)(0x80 | (codePoint & 0x3F)));
+            } else {
+                output.Add((ANSICHAR)(0xF0 | (codePoint >> 18)));
+                output.Add((ANSICHAR)(0x80 | ((codePoint >> 12) & 0x3F)));
+                output.Add((ANSICHAR)(0x80 | ((codePoint >> 6) & 0x3F)));
+                output.Add((ANSICHAR)(0x80 | (codePoint & 0x3F)));
+            }
+        }
+
+        const ANSICHAR* _current;
+        const ANSICHAR* _end;
+        bool _hasError = false;
+    };
+
+    bool IsKey(const FAnsiStringView& key, const ANSICHAR* name) {
+        int32 nameLength = FCStringAnsi::Strlen(name);
+        return key.Len() == nameLength && FCStringAnsi::Strncmp(key.GetData(), name, nameLength) == 0;
+    }
+
+    /**
+     * Parses a single element of the Modules array. If nameOnly is set, this
+     * stops as soon as the name has been read.
+     */
+    bool ReadModuleObject(const ANSICHAR* begin, const ANSICHAR* end, FUhtModuleHeaders& outModule, bool nameOnly) {
+        FJsonScanner scanner(begin, end);
+        if (!scanner.Consume('{')) {
+            return false;
+        }
+        if (scanner.Peek() == '}') {
+            return true;
+        }
+
+        while (!scanner.HasError()) {
+            FAnsiStringView key;
+            if (!scanner.ReadKey(key)) {
+                return false;
+            }
+
+            if (IsKey(key, "Name")) {
+                scanner.ReadString(outModule.Name);
+                if (nameOnly) {
+                    return !scanner.HasError();
+                }
+            } else if (IsKey(key, "BaseDirectory")) {
+                scanner.ReadString(outModule.BaseDirectory);
+            } else if (IsKey(key, "PublicHeaders")) {
+                scanner.ReadStringArray(outModule.PublicHeaders);
+            } else if (IsKey(key, "InternalHeaders")) {
+                scanner.ReadStringArray(outModule.InternalHeaders);
+            } else if (IsKey(key, "PrivateHeaders")) {
+                scanner.ReadStringArray(outModule.PrivateHeaders);
+            } else {
+                scanner.SkipValue();
+            }
+
+            ANSICHAR next = scanner.Peek();
+            if (next == '}') {
+                return !scanner.HasError();
+            } else if (!scanner.Consume(',')) {
+                return false;
+            }
+        }
+        return false;
+    }
+}
+
+bool FUhtManifestReader::FindModules(FMemoryView manifestBytes, TArray<FUhtModuleLocation>& outModules) {
+    const ANSICHAR* fileStart = (const ANSICHAR*)manifestBytes.GetData();
+    const ANSICHAR* begin = fileStart;
+    const ANSICHAR* end = begin + manifestBytes.GetSize();
+
+    // Skip the UTF-8 byte order mark if there is one
+    if (end - begin >= 3 && (uint8)begin[0] == 0xEF && (uint8)begin[1] == 0xBB && (uint8)begin[2] == 0xBF) {
+        begin += 3;
+    }
+
+    bool foundModules = false;
+    FJsonScanner scanner(begin, end);
+    if (!scanner.Consume('{')) {
+        UE_LOG(UhtManifestReaderSub, Error, TEXT("The UHT manifest does not start with a JSON object."));
+        return false;
+    }
+
+    while (!scanner.HasError() && scanner.Peek() != '}') {
+        FAnsiStringView key;
+        if (!scanner.ReadKey(key)) {
+            break;
+        }
+
+        if (IsKey(key, "Modules") && scanner.Peek() == '[') {
+            foundModules = true;
+            scanner.Consume('[');
+            while (!scanner.HasError() && scanner.Peek() != ']') {
+                scanner.SkipWhitespace();
+                const ANSICHAR* moduleStart = scanner.GetPosition();
+                if (!scanner.SkipValue()) {
+                    break;
+                }
+
+                FUhtModuleLocation& location = outModules.AddDefaulted_GetRef();
+                location.Order = outModules.Num() - 1;
+                location.Offset = moduleStart - fileStart;
+                location.Size = scanner.GetPosition() - moduleStart;
+
+                if (scanner.Peek() == ',') {
+                    scanner.Consume(',');
+                }
+            }
+            scanner.Consume(']');
+        } else {
+            scanner.SkipValue();
+        }
+
+        if (scanner.Peek() == ',') {
+            scanner.Consume(',');
+        }
+    }
+
+    if (scanner.HasError() || !foundModules) {
+        UE_LOG(UhtManifestReaderSub, Error, TEXT("The UHT manifest could not be read. Could the file be corrupt?"));
+        return false;
+    }
+
+    // Read the name of each module
+    std::atomic<bool> hasError = false;
+    ParallelFor(outModules.Num(), [fileStart, &outModules, &hasError] (int32 index) {
+        FUhtModuleLocation& location = outModules[index];
+        const ANSICHAR* moduleStart = fileStart + location.Offset;
+        FUhtModuleHeaders moduleHeaders;
+        if (ReadModuleObject(moduleStart, moduleStart + location.Size, moduleHeaders, true)) {
+            location.Name = MoveTemp(moduleHeaders.Name);
+        } else {
+            hasError = true;
+        }
+    });
+
+    if (hasError) {
+        UE_LOG(UhtManifestReaderSub, Error, TEXT("A module in the UHT manifest could not be read. Could the file be corrupt?"));
+        return false;
+    }
+
+    return true;
+}
+
+bool FUhtManifestReader::ReadModule(FMemoryView moduleBytes, FUhtModuleHeaders& outModule) {
+    const ANSICHAR* begin = (const ANSICHAR*)moduleBytes.GetData();
+    return ReadModuleObject(begin, begin + moduleBytes.GetSize(), outModule, false);
+}
+
+bool FUhtManifestReader::ReadModules(FMemoryView manifestBytes, TArray<FUhtModuleHeaders>& outModules) {
+    // First find where each module is so they can be parsed in parallel
+    TArray<FUhtModuleLocation> locations;
+    if (!FindModules(manifestBytes, locations)) {
+        return false;
+    }
+
+    const ANSICHAR* fileStart = (const ANSICHAR*)manifestBytes.GetData();
+    outModules.SetNum(locations.Num());
+    std::atomic<bool> hasError = false;
+    ParallelFor(locations.Num(), [fileStart, &locations, &outModules, &hasError] (int32 index) {
+        const ANSICHAR* moduleStart = fileStart + locations[index].Offset;
+        if (!ReadModuleObject(moduleStart, moduleStart + locations[index].Size, outModules[index], false)) {
+            hasError = true;
+        }
+    });
+
+    if (hasError) {
+        UE_LOG(UhtManifestReaderSub, Error, TEXT("A module in the UHT manifest could not be read. Could the file be corrupt?"));
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Memory/MemoryView.h"
+
+/**
+ * The parts of a module entry in the UHT manifest that are needed to find its headers.
+ */
+struct FUhtModuleHeaders {
+    FString Name;
+    FString BaseDirectory;
+    TArray<FString> PublicHeaders;
+    TArray<FString> InternalHeaders;
+    TArray<FString> PrivateHeaders;
+};
+
+/**
+ * Where a module's entry is in the UHT manifest.
+ */
+struct FUhtModuleLocation {
+    FString Name;
+
+    // Byte range of the module's JSON object in the manifest
+    int64 Offset = 0;
+    int64 Size = 0;
+
+    // Position of the module in the manifest
+    int32 Order = 0;
+};
+
+/**
+ * Reads the module header lists out of a UHT manifest without building a JSON DOM.
+ * The manifest is scanned once to find where each module entry is, and then the
+ * module entries are parsed in parallel. Every other field is skipped over.
+ */
+class FUhtManifestReader {
+public:
+    /**
+     * Reads the modules from the given manifest contents.
+     * @param manifestBytes The UTF-8 contents of the manifest file.
+     * @param outModules Filled with the modules in the order they appear in the manifest.
+     * @return Returns false if the manifest is not valid JSON or has no Modules array.
+     */
+    static bool ReadModules(FMemoryView manifestBytes, TArray<FUhtModuleHeaders>& outModules);
+
+    /**
+     * Finds where each module is in the manifest without reading anything but their names.
+     * @param manifestBytes The UTF-8 contents of the manifest file.
+     * @param outModules Filled with the location of each module in the order they appear in the manifest.
+     * @return Returns false if the manifest is not valid JSON or has no Modules array.
+     */
+    static bool FindModules(FMemoryView manifestBytes, TArray<FUhtModuleLocation>& outModules);
+
+    /**
+     * Reads a single module found with FindModules.
+     * @param moduleBytes The part of the manifest given by the module's location.
+     * @param outModule Filled with the module's headers.
+     * @return Returns false if the bytes are not a valid module entry.
+     */
+    static bool ReadModule(FMemoryView moduleBytes, FUhtModuleHeaders& outModule);
+};
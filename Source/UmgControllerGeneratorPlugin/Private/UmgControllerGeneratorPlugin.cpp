@@ -1,6 +1,12 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "UmgControllerGeneratorPlugin.h"
+#include "UmgControllerGeneratorPluginBPLibrary.h"
+#include "CodeGenerator.h"
+#include "CodeGeneratorConfig.h"
+#include "Misc/CoreDelegates.h"
+#include "Framework/Application/SlateApplication.h"
+#include "ISettingsModule.h"
 
 #define LOCTEXT_NAMESPACE "FUmgControllerGeneratorPluginModule"
 
@@ -8,6 +14,9 @@ void FUmgControllerGeneratorPluginModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
 	
+	// The warm-up waits for the editor to finish starting so it doesn't add to the startup time
+	// The settings are registered then too since the Settings module isn't loaded this early
+	_postEngineInitHandle = FCoreDelegates::OnPostEngineInit.AddRaw(this, &FUmgControllerGeneratorPluginModule::OnPostEngineInit);
 }
 
 void FUmgControllerGeneratorPluginModule::ShutdownModule()
@@ -15,8 +24,65 @@ void FUmgControllerGeneratorPluginModule::ShutdownModule()
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
 	
+	FCoreDelegates::OnPostEngineInit.Remove(_postEngineInitHandle);
+
+	ISettingsModule* settingsModule = FModuleManager::GetModulePtr<ISettingsModule>("Settings");
+	if (settingsModule != nullptr) {
+		settingsModule->UnregisterSettings("Project", "Plugins", "UmgControllerGenerator");
+	}
+	if (_warmUpTickerHandle.IsValid()) {
+		FTSTicker::GetCoreTicker().RemoveTicker(_warmUpTickerHandle);
+		_warmUpTickerHandle.Reset();
+	}
+}
+
+void FUmgControllerGeneratorPluginModule::OnPostEngineInit()
+{
+	// The code generator reads the settings object directly so changes made here apply without a restart
+	ISettingsModule* settingsModule = FModuleManager::GetModulePtr<ISettingsModule>("Settings");
+	if (settingsModule != nullptr) {
+		settingsModule->RegisterSettings("Project", "Plugins", "UmgControllerGenerator",
+			LOCTEXT("SettingsName", "UMG Controller Generator"),
+			LOCTEXT("SettingsDescription", "Configure how UMG controllers are generated."),
+			GetMutableDefault<UCodeGeneratorConfig>());
+	}
+
+	if (!GIsEditor || IsRunningCommandlet()) {
+		return;
+	}
+
+	const UCodeGeneratorConfig* config = GetDefault<UCodeGeneratorConfig>();
+	if (config->TrackAssetChanges) {
+		UUmgControllerGeneratorPluginBPLibrary::GetCodeGenerator()->StartWatchingAssets();
+	}
+
+	if (config->EnableBackgroundWarmUp) {
+		// Check about once a second whether the user has been idle long enough
+		_warmUpTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+			FTickerDelegate::CreateRaw(this, &FUmgControllerGeneratorPluginModule::OnWarmUpTick),
+			1.0f);
+	}
+}
+
+bool FUmgControllerGeneratorPluginModule::OnWarmUpTick(float deltaTime)
+{
+	if (!FSlateApplication::IsInitialized() || GIsSlowTask) {
+		return true; // Try again later
+	}
+
+	UCodeGenerator* codeGenerator = UUmgControllerGeneratorPluginBPLibrary::GetCodeGenerator();
+	double idleSeconds = FPlatformTime::Seconds() - FSlateApplication::Get().GetLastUserInteractionTime();
+	if (idleSeconds < codeGenerator->GetWarmUpIdleSeconds()) {
+		return true;
+	}
+
+	codeGenerator->StartWarmUp();
+
+	// Only warm up once. After that the tables are kept up to date as they're used.
+	_warmUpTickerHandle.Reset();
+	return false;
 }
 
 #undef LOCTEXT_NAMESPACE
 	
-IMPLEMENT_MODULE(FUmgControllerGeneratorPluginModule, UmgControllerGeneratorPlugin)
\ No newline at end of file
+IMPLEMENT_MODULE(FUmgControllerGeneratorPluginModule, UmgControllerGeneratorPlugin)
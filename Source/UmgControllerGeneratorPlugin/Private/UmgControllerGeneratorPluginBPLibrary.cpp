@@ -1,10 +1,9 @@
 #include "UmgControllerGeneratorPluginBPLibrary.h"
 #include "UmgControllerGeneratorPlugin.h"
-#include "Components/Widget.h"
 #include "WidgetBlueprint.h"
-#include "Blueprint/WidgetTree.h"
 #include "CodeGenerator.h"
 #include "BlueprintSourceMap.h"
+#include "ControllerGenerationJob.h"
 
 DEFINE_LOG_CATEGORY_STATIC(UmgControllerGeneratorPluginSub, Log, All);
 
@@ -20,35 +19,10 @@ void UUmgControllerGeneratorPluginBPLibrary::CreateUmgController(UObject* inputB
 		return;
 	}
 
-	UWidgetTree* widgetTree = blueprint->WidgetTree;
-
-	TArray<UWidget*> widgets;
-	widgetTree->ForEachWidget([&widgets] (UWidget* widget) {
-		UE_LOG(UmgControllerGeneratorPluginSub, Display, TEXT("Widget: %s of type %s"), *widget->GetName(), *widget->GetClass()->GetName());
-		widgets.Add(widget);
-	});
-
-	FString name = blueprint->GetName();
-	FString wbpPrefix = TEXT("WBP_");
-	if (name.StartsWith(wbpPrefix)) {
-		name = name.RightChop(wbpPrefix.Len());
-	}
-
-	// Get the widget path name.
-	FString contentPath = blueprint->GetPathName();
-
-	// We don't need the extension
-	int dotIndex = -1;
-	if (contentPath.FindLastChar(TEXT('.'), dotIndex)) {
-		contentPath = contentPath.Left(dotIndex);
-	}
-
 	GetCodeGenerator()->CreateFiles(
 		blueprint,
-		contentPath,
-		name,
+		GetCodeGenerator()->CreateSnapshot(blueprint),
 		GetCodeGenerator()->GetClassSuffix(),
-		widgets,
 		headerPath,
 		cppPath
 	);
@@ -62,38 +36,51 @@ bool UUmgControllerGeneratorPluginBPLibrary::UpdateUmgController(UObject* inputB
 		return false;
 	}
 
-    UBlueprintSourceMap* sourceMap = NewObject<UBlueprintSourceMap>();
-    sourceMap->LoadMapping(FPaths::ProjectDir(), GetCodeGenerator()->GetBlueprintSourceFilePath());
+    UBlueprintSourceMap* sourceMap = GetCodeGenerator()->GetBlueprintSourceMap();
 	FBlueprintSourceModel entry = sourceMap->GetSourcePathsFor(blueprint);
 	if (!entry.IsValid()) {
 		UE_LOG(UmgControllerGeneratorPluginSub, Error, TEXT("No source map entry for %s. Fix the mapping or try Update Mappings."), *blueprint->GetPathName());
 		return false;
 	}
 
-	UWidgetTree* widgetTree = blueprint->WidgetTree;
-	TArray<UWidget*> widgets;
-	widgetTree->ForEachWidget([&widgets] (UWidget* widget) {
-		UE_LOG(UmgControllerGeneratorPluginSub, Display, TEXT("Widget: %s of type %s"), *widget->GetName(), *widget->GetClass()->GetName());
-		widgets.Add(widget);
-	});
-
-	FString name = blueprint->GetName();
-	FString wbpPrefix = TEXT("WBP_");
-	if (name.StartsWith(wbpPrefix)) {
-		name = name.RightChop(wbpPrefix.Len());
+	GetCodeGenerator()->UpdateFiles(GetCodeGenerator()->CreateSnapshot(blueprint), GetCodeGenerator()->GetClassSuffix(), entry.HeaderPath, entry.CppPath);
+
+	return true;
+}
+
+bool UUmgControllerGeneratorPluginBPLibrary::UpdateUmgControllers(TArray<UObject*> inputBlueprints) {
+	TArray<FString> blueprintPaths;
+	int index = 0;
+	for (UObject* obj : inputBlueprints) {
+		UWidgetBlueprint* blueprint = Cast<UWidgetBlueprint>(obj);
+		if (blueprint == nullptr) {
+			UE_LOG(UmgControllerGeneratorPluginSub, Error, TEXT("UpdateUmgControllers called without a widget blueprint in index %d."), index);
+		} else {
+			blueprintPaths.Add(blueprint->GetPathName());
+		}
+		index++;
 	}
 
-	// Get the widget path name.
-	FString contentPath = blueprint->GetPathName();
+	return UpdateControllersAt(blueprintPaths);
+}
 
-	// We don't need the extension
-	int dotIndex = -1;
-	if (contentPath.FindLastChar(TEXT('.'), dotIndex)) {
-		contentPath = contentPath.Left(dotIndex);
+bool UUmgControllerGeneratorPluginBPLibrary::UpdateUmgControllersInFolder(FString folderPath) {
+	TArray<FString> blueprintPaths = GetCodeGenerator()->FindMappedBlueprintsIn(folderPath);
+	if (blueprintPaths.Num() == 0) {
+		GetCodeGenerator()->ShowNotification(FString::Printf(TEXT("No controllers found in %s."), *folderPath), ENotificationReason::Warning);
+		return true;
 	}
 
-	GetCodeGenerator()->UpdateFiles(name, GetCodeGenerator()->GetClassSuffix(), contentPath, widgets, entry.HeaderPath, entry.CppPath);
+	return UpdateControllersAt(blueprintPaths);
+}
 
+bool UUmgControllerGeneratorPluginBPLibrary::UpdateControllersAt(const TArray<FString>& blueprintPaths) {
+	TArray<FControllerUpdateResult> results = GetCodeGenerator()->UpdateAllFiles(blueprintPaths);
+	for (const FControllerUpdateResult& result : results) {
+		if (result.Status != EControllerUpdateStatus::Updated && result.Status != EControllerUpdateStatus::UpToDate) {
+			return false;
+		}
+	}
 	return true;
 }
 
@@ -110,9 +97,9 @@ bool UUmgControllerGeneratorPluginBPLibrary::UpdateMappings(TArray<UObject*> inp
 		index++;
 	}
 
-    UBlueprintSourceMap* sourceMap = NewObject<UBlueprintSourceMap>();
-    sourceMap->LoadMapping(FPaths::ProjectDir(), GetCodeGenerator()->GetBlueprintSourceFilePath());
-	if (sourceMap->UpdateMappings(blueprints, GetCodeGenerator()->GetClassSuffix())) {
+    UBlueprintSourceMap* sourceMap = GetCodeGenerator()->GetBlueprintSourceMap();
+	UCodeGenerator* codeGenerator = GetCodeGenerator();
+	if (sourceMap->UpdateMappings(blueprints, codeGenerator->GetClassSuffix(), codeGenerator->GetMappingSearchExcludedDirectories(), codeGenerator->GetMappingSearchExtensions())) {
 		GetCodeGenerator()->ShowNotification(TEXT("Mappings updated."), ENotificationReason::Success);
 		return true;
 	} else {
@@ -121,6 +108,10 @@ bool UUmgControllerGeneratorPluginBPLibrary::UpdateMappings(TArray<UObject*> inp
 	}
 }
 
+FString UUmgControllerGeneratorPluginBPLibrary::FindBlueprintForSourceFile(FString sourcePath) {
+	return GetCodeGenerator()->GetBlueprintSourceMap()->GetBlueprintPathFor(sourcePath);
+}
+
 UCodeGenerator* UUmgControllerGeneratorPluginBPLibrary::GetCodeGenerator() {
 	if (_codeGeneratorInstance == nullptr) {
 		_codeGeneratorInstance = NewObject<UCodeGenerator>();
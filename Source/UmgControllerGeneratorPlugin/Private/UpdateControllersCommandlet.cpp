@@ -0,0 +1,266 @@
+#include "UpdateControllersCommandlet.h"
+#include "UmgControllerGeneratorPluginBPLibrary.h"
+#include "CodeGenerator.h"
+#include "CodeGeneratorConfig.h"
+#include "BlueprintSourceMap.h"
+#include "ControllerGenerationJob.h"
+#include "JsonObjectConverter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+
+DEFINE_LOG_CATEGORY_STATIC(UpdateControllersCommandletSub, Log, All);
+
+UUpdateControllersCommandlet::UUpdateControllersCommandlet() {
+    IsClient = false;
+    IsEditor = true;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+int32 UUpdateControllersCommandlet::Main(const FString& params) {
+    TArray<FString> tokens;
+    TArray<FString> switches;
+    TMap<FString, FString> paramValues;
+    ParseCommandLine(*params, tokens, switches, paramValues);
+
+    bool comparePrefetch = switches.Contains(TEXT("ComparePrefetch"));
+
+    // Both passes of a comparison have to do the same work and the second would find nothing to write
+    bool verifyOnly = switches.Contains(TEXT("Verify")) || comparePrefetch;
+    const FString* reportPath = paramValues.Find(TEXT("Report"));
+
+    if (const FString* reportPattern = paramValues.Find(TEXT("Merge"))) {
+        if (reportPath == nullptr) {
+            UE_LOG(UpdateControllersCommandletSub, Error, TEXT("-Merge needs a -Report to write the merged report to."));
+            return 1;
+        }
+        return MergeReports(*reportPattern, *reportPath);
+    }
+
+    int32 shardIndex = 1;
+    int32 shardCount = 1;
+    if (const FString* shardSpec = paramValues.Find(TEXT("Shard"))) {
+        if (!ParseShard(*shardSpec, shardIndex, shardCount)) {
+            UE_LOG(UpdateControllersCommandletSub, Error, TEXT("Invalid shard %s. It should look like -Shard=3/8."), **shardSpec);
+            return 1;
+        }
+    }
+
+    // These only last as long as the commandlet since the settings aren't saved
+    UCodeGeneratorConfig* config = GetMutableDefault<UCodeGeneratorConfig>();
+    if (const FString* windowSize = paramValues.Find(TEXT("WindowSize"))) {
+        config->BatchWindowSize = FMath::Max(FCString::Atoi(**windowSize), 0);
+    }
+    if (const FString* memoryCeiling = paramValues.Find(TEXT("MemoryCeilingMB"))) {
+        config->BatchMemoryCeilingMB = FMath::Max(FCString::Atoi(**memoryCeiling), 0);
+    }
+    if (const FString* prefetchCount = paramValues.Find(TEXT("PrefetchCount"))) {
+        config->BatchPrefetchCount = FMath::Max(FCString::Atoi(**prefetchCount), 0);
+    }
+
+    // Commandlets don't discover assets on their own
+    IAssetRegistry& assetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+    assetRegistry.SearchAllAssets(true);
+
+    UCodeGenerator* codeGenerator = UUmgControllerGeneratorPluginBPLibrary::GetCodeGenerator();
+    TArray<FString> blueprintPaths;
+    if (const FString* folderPath = paramValues.Find(TEXT("Folder"))) {
+        blueprintPaths = codeGenerator->FindMappedBlueprintsIn(*folderPath);
+    } else {
+        blueprintPaths = codeGenerator->GetBlueprintSourceMap()->GetBlueprintPaths();
+    }
+
+    if (shardCount > 1) {
+        blueprintPaths.RemoveAll([shardIndex, shardCount] (const FString& blueprintPath) {
+            return !IsInShard(blueprintPath, shardIndex, shardCount);
+        });
+    }
+
+    UE_LOG(UpdateControllersCommandletSub, Display, TEXT("%s %d controllers in shard %d of %d."), verifyOnly ? TEXT("Verifying") : TEXT("Regenerating"), blueprintPaths.Num(), shardIndex, shardCount);
+    TArray<FControllerBatchWindow> windows;
+    double startTime = FPlatformTime::Seconds();
+    TArray<FControllerUpdateResult> results = codeGenerator->UpdateAllFiles(blueprintPaths, verifyOnly, &windows);
+    double elapsedSeconds = FPlatformTime::Seconds() - startTime;
+
+    FControllerReportModel report;
+    report.Mode = verifyOnly ? TEXT("Verify") : TEXT("Regenerate");
+    report.Succeeded = true;
+    report.ShardIndex = shardIndex;
+    report.ShardCount = shardCount;
+    report.PrefetchCount = config->BatchPrefetchCount;
+    report.Seconds = elapsedSeconds;
+    report.ControllersPerSecond = elapsedSeconds > 0.0 ? results.Num() / elapsedSeconds : 0.0;
+    report.AsyncLoadingThread = IsAsyncLoadingMultithreaded();
+    for (const FControllerUpdateResult& result : results) {
+        FControllerReportEntryModel& entry = report.Controllers.AddDefaulted_GetRef();
+        entry.Blueprint = result.BlueprintPath;
+        entry.Status = LexToString(result.Status);
+        entry.Message = result.Message;
+
+        if (result.Status != EControllerUpdateStatus::Updated && result.Status != EControllerUpdateStatus::UpToDate) {
+            report.Succeeded = false;
+        }
+    }
+
+    const uint64 bytesPerMB = 1024 * 1024;
+    for (const FControllerBatchWindow& window : windows) {
+        FControllerReportWindowModel& windowModel = report.Windows.AddDefaulted_GetRef();
+        windowModel.BlueprintCount = window.BlueprintCount;
+        windowModel.PeakWorkingSetMB = (int32)(window.PeakUsedPhysical / bytesPerMB);
+        windowModel.WorkingSetAfterCollectMB = (int32)(window.UsedPhysicalAfterCollect / bytesPerMB);
+    }
+
+    if (comparePrefetch) {
+        ComparePrefetch(codeGenerator, blueprintPaths, report);
+    }
+
+    if (reportPath != nullptr && !WriteReport(*reportPath, report)) {
+        report.Succeeded = false;
+    }
+
+    return report.Succeeded ? 0 : 1;
+}
+
+/**
+ * Runs the batch again loading one blueprint at a time and adds how long it took to the report.
+ */
+void UUpdateControllersCommandlet::ComparePrefetch(UCodeGenerator* codeGenerator, const TArray<FString>& blueprintPaths, FControllerReportModel& report) {
+    // Unload everything the first pass loaded so this one has to load the packages again
+    CollectGarbage(RF_NoFlags);
+
+    UCodeGeneratorConfig* config = GetMutableDefault<UCodeGeneratorConfig>();
+    int32 prefetchCount = config->BatchPrefetchCount;
+    config->BatchPrefetchCount = 0;
+
+    double startTime = FPlatformTime::Seconds();
+    codeGenerator->UpdateAllFiles(blueprintPaths, true);
+    report.SerialSeconds = FPlatformTime::Seconds() - startTime;
+    config->BatchPrefetchCount = prefetchCount;
+
+    report.SerialControllersPerSecond = report.SerialSeconds > 0.0 ? blueprintPaths.Num() / report.SerialSeconds : 0.0;
+    report.PrefetchSpeedup = report.Seconds > 0.0 ? report.SerialSeconds / report.Seconds : 0.0;
+    UE_LOG(UpdateControllersCommandletSub, Display, TEXT("Prefetching %d blueprints took %.2f s and loading them one at a time took %.2f s (%.2fx). The async loading thread is %s."),
+        prefetchCount, report.Seconds, report.SerialSeconds, report.PrefetchSpeedup, report.AsyncLoadingThread ? TEXT("on") : TEXT("off"));
+}
+
+/**
+ * Combines the reports from each shard of a run into one with the results sorted by blueprint.
+ */
+int32 UUpdateControllersCommandlet::MergeReports(const FString& reportPattern, const FString& reportPath) {
+    FString fullReportPattern = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), reportPattern);
+    FString reportDirectory = FPaths::GetPath(fullReportPattern);
+    FString fullReportPath = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), reportPath);
+
+    TArray<FString> reportFileNames;
+    IFileManager::Get().FindFiles(reportFileNames, *fullReportPattern, true, false);
+    reportFileNames.Sort();
+
+    FControllerReportModel mergedReport;
+    mergedReport.Succeeded = true;
+    TSet<int32> shardIndices;
+    int32 shardCount = 0;
+    for (const FString& reportFileName : reportFileNames) {
+        FString shardReportPath = FPaths::Combine(reportDirectory, reportFileName);
+        if (FPaths::IsSamePath(shardReportPath, fullReportPath)) {
+            // The merged report may match the pattern from a previous merge
+            continue;
+        }
+
+        FString fileContents;
+        FControllerReportModel shardReport;
+        if (!FFileHelper::LoadFileToString(fileContents, *shardReportPath) || !FJsonObjectConverter::JsonObjectStringToUStruct(fileContents, &shardReport, 0, 0)) {
+            UE_LOG(UpdateControllersCommandletSub, Error, TEXT("Could not read the report at %s"), *shardReportPath);
+            return 1;
+        }
+
+        if (shardCount == 0) {
+            shardCount = shardReport.ShardCount;
+            mergedReport.Mode = shardReport.Mode;
+            mergedReport.PrefetchCount = shardReport.PrefetchCount;
+            mergedReport.AsyncLoadingThread = shardReport.AsyncLoadingThread;
+        } else if (shardReport.ShardCount != shardCount || shardReport.Mode != mergedReport.Mode) {
+            UE_LOG(UpdateControllersCommandletSub, Error, TEXT("%s is from a different run than the other reports."), *shardReportPath);
+            return 1;
+        }
+
+        bool isAlreadyMerged = false;
+        shardIndices.Add(shardReport.ShardIndex, &isAlreadyMerged);
+        if (isAlreadyMerged) {
+            UE_LOG(UpdateControllersCommandletSub, Error, TEXT("There's more than one report for shard %d."), shardReport.ShardIndex);
+            return 1;
+        }
+
+        mergedReport.Succeeded &= shardReport.Succeeded;
+
+        // The shards run side by side so the run takes as long as the slowest one
+        mergedReport.Seconds = FMath::Max(mergedReport.Seconds, shardReport.Seconds);
+        mergedReport.SerialSeconds = FMath::Max(mergedReport.SerialSeconds, shardReport.SerialSeconds);
+        mergedReport.Controllers.Append(MoveTemp(shardReport.Controllers));
+    }
+
+    if (shardCount == 0) {
+        UE_LOG(UpdateControllersCommandletSub, Error, TEXT("No reports found matching %s"), *fullReportPattern);
+        return 1;
+    }
+
+    for (int32 shardIndex = 1; shardIndex <= shardCount; shardIndex++) {
+        if (!shardIndices.Contains(shardIndex)) {
+            UE_LOG(UpdateControllersCommandletSub, Error, TEXT("The report for shard %d of %d is missing."), shardIndex, shardCount);
+            mergedReport.Succeeded = false;
+        }
+    }
+
+    mergedReport.ControllersPerSecond = mergedReport.Seconds > 0.0 ? mergedReport.Controllers.Num() / mergedReport.Seconds : 0.0;
+    mergedReport.SerialControllersPerSecond = mergedReport.SerialSeconds > 0.0 ? mergedReport.Controllers.Num() / mergedReport.SerialSeconds : 0.0;
+    mergedReport.PrefetchSpeedup = mergedReport.SerialSeconds > 0.0 && mergedReport.Seconds > 0.0 ? mergedReport.SerialSeconds / mergedReport.Seconds : 0.0;
+    mergedReport.Controllers.Sort([] (const FControllerReportEntryModel& left, const FControllerReportEntryModel& right) {
+        return left.Blueprint < right.Blueprint;
+    });
+
+    UE_LOG(UpdateControllersCommandletSub, Display, TEXT("Merged %d reports with %d controllers."), shardIndices.Num(), mergedReport.Controllers.Num());
+    if (!WriteReport(reportPath, mergedReport)) {
+        return 1;
+    }
+
+    return mergedReport.Succeeded ? 0 : 1;
+}
+
+bool UUpdateControllersCommandlet::WriteReport(const FString& reportPath, const FControllerReportModel& report) {
+    FString fullReportPath = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), reportPath);
+
+    FString jsonString;
+    if (!FJsonObjectConverter::UStructToJsonObjectString(report, jsonString)) {
+        UE_LOG(UpdateControllersCommandletSub, Error, TEXT("Could not convert the report to json."));
+        return false;
+    }
+
+    if (!FFileHelper::SaveStringToFile(jsonString, *fullReportPath)) {
+        UE_LOG(UpdateControllersCommandletSub, Error, TEXT("Could not write the report to %s"), *fullReportPath);
+        return false;
+    }
+
+    UE_LOG(UpdateControllersCommandletSub, Display, TEXT("Wrote the report to %s"), *fullReportPath);
+    return true;
+}
+
+bool UUpdateControllersCommandlet::ParseShard(const FString& shardSpec, int32& outShardIndex, int32& outShardCount) {
+    FString shardIndexString;
+    FString shardCountString;
+    if (!shardSpec.Split(TEXT("/"), &shardIndexString, &shardCountString) || !shardIndexString.IsNumeric() || !shardCountString.IsNumeric()) {
+        return false;
+    }
+
+    outShardIndex = FCString::Atoi(*shardIndexString);
+    outShardCount = FCString::Atoi(*shardCountString);
+    return outShardCount > 0 && outShardIndex >= 1 && outShardIndex <= outShardCount;
+}
+
+bool UUpdateControllersCommandlet::IsInShard(const FString& blueprintPath, int32 shardIndex, int32 shardCount) {
+    // The hash has to be the same on every machine so each blueprint ends up in exactly one shard
+    FTCHARToUTF8 utf8Path(*blueprintPath);
+    uint32 hash = FCrc::MemCrc32(utf8Path.Get(), utf8Path.Length());
+    return (int32)(hash % (uint32)shardCount) == shardIndex - 1;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "UpdateControllersCommandlet.generated.h"
+
+USTRUCT()
+struct FControllerReportEntryModel {
+    GENERATED_BODY()
+
+    UPROPERTY() // Reference path of the blueprint
+    FString Blueprint = TEXT("");
+
+    UPROPERTY() // Updated, UpToDate, OutOfDate, Failed or Cancelled
+    FString Status = TEXT("");
+
+    UPROPERTY() // Why it failed if it did
+    FString Message = TEXT("");
+};
+
+USTRUCT()
+struct FControllerReportWindowModel {
+    GENERATED_BODY()
+
+    UPROPERTY()
+    int32 BlueprintCount = 0;
+
+    UPROPERTY() // The most memory used while the window's blueprints were loaded
+    int32 PeakWorkingSetMB = 0;
+
+    UPROPERTY() // The memory used after collecting garbage at the end of the window
+    int32 WorkingSetAfterCollectMB = 0;
+};
+
+USTRUCT()
+struct FControllerReportModel {
+    GENERATED_BODY()
+
+    UPROPERTY() // Regenerate or Verify
+    FString Mode = TEXT("");
+
+    UPROPERTY()
+    bool Succeeded = false;
+
+    UPROPERTY() // Which shard this is from 1 to ShardCount
+    int32 ShardIndex = 1;
+
+    UPROPERTY()
+    int32 ShardCount = 1;
+
+    UPROPERTY() // How many blueprints were loaded ahead of the one being read. 0 loads them one at a time.
+    int32 PrefetchCount = 0;
+
+    UPROPERTY() // How long the whole batch took
+    double Seconds = 0.0;
+
+    UPROPERTY()
+    double ControllersPerSecond = 0.0;
+
+    UPROPERTY() // Whether packages were serialized on the async loading thread. Without it, prefetching only overlaps the reads.
+    bool AsyncLoadingThread = false;
+
+    UPROPERTY() // With -ComparePrefetch, how long the same batch took loading one blueprint at a time
+    double SerialSeconds = 0.0;
+
+    UPROPERTY()
+    double SerialControllersPerSecond = 0.0;
+
+    UPROPERTY() // SerialSeconds divided by Seconds
+    double PrefetchSpeedup = 0.0;
+
+    UPROPERTY()
+    TArray<FControllerReportEntryModel> Controllers;
+
+    UPROPERTY() // Only in the reports of each shard
+    TArray<FControllerReportWindowModel> Windows;
+};
+
+/**
+ * Regenerates or verifies the controllers of every mapped widget blueprint without the editor UI
+ * so it can run on build machines. For example:
+ *
+ *     UnrealEditor-Cmd MyGame.uproject -run=UpdateControllers -Verify -Report=Saved/Controllers.json -nullrhi
+ *
+ * Options:
+ *     -Verify           Only check that the controllers are up to date. Nothing is written.
+ *     -Folder=/Game/UI  Only the blueprints in this content folder and its subfolders.
+ *     -Shard=3/8        Only the third of eight shards. Blueprints are assigned to shards by a hash of their
+ *                       path so separate processes or machines can each do one without overlapping.
+ *     -WindowSize=64    How many blueprints to load before collecting garbage. Overrides BatchWindowSize.
+ *     -MemoryCeilingMB=8192  Shrinks the windows while memory use is over this. Overrides BatchMemoryCeilingMB.
+ *     -PrefetchCount=8  How many blueprints to load asynchronously ahead of the one being read. 0 loads them
+ *                       one at a time, which is useful to compare against. Overrides BatchPrefetchCount.
+ *     -ComparePrefetch  Verifies the batch twice, first prefetching and then loading one blueprint at a time,
+ *                       and adds the time of both to the report. Implies -Verify. The second pass may gain from
+ *                       the file system cache so the speedup it reports is on the low side.
+ *     -Report=<path>    Writes the result for each blueprint and the memory used by each window as JSON.
+ *                       Relative paths are relative to the project.
+ *     -Merge=<pattern>  Instead of updating anything, combines the reports matching the wildcard pattern from
+ *                       each shard into the one given by -Report. Fails if a shard is missing.
+ *
+ * Returns 0 if every controller was updated or was already up to date and 1 otherwise.
+ */
+UCLASS()
+class UUpdateControllersCommandlet : public UCommandlet {
+    GENERATED_BODY()
+
+public:
+    UUpdateControllersCommandlet();
+    virtual int32 Main(const FString& params) override;
+
+    /**
+     * Parses a shard given as "index/count" where index is from 1 to count.
+     * @return Returns false if the shard isn't in that form or the index is out of range.
+     */
+    static bool ParseShard(const FString& shardSpec, int32& outShardIndex, int32& outShardCount);
+
+    /**
+     * Returns true if the blueprint at the given path belongs to the given shard. Every path
+     * is in exactly one shard and is in the same one on every machine.
+     */
+    static bool IsInShard(const FString& blueprintPath, int32 shardIndex, int32 shardCount);
+
+private:
+    int32 MergeReports(const FString& reportPattern, const FString& reportPath);
+    void ComparePrefetch(class UCodeGenerator* codeGenerator, const TArray<FString>& blueprintPaths, FControllerReportModel& report);
+    bool WriteReport(const FString& reportPath, const FControllerReportModel& report);
+};
@@ -0,0 +1,13 @@
+#include "WidgetTreeSnapshot.h"
+
+TArray<FString> FWidgetTreeSnapshot::GetIncludePaths() const {
+    TSet<FString> includes;
+    for (const FWidgetSnapshot& widget : Widgets) {
+        if (!widget.IncludePath.IsEmpty()) {
+            includes.Add(widget.IncludePath);
+        }
+    }
+
+    includes.Sort(TLess<FString>());
+    return includes.Array();
+}
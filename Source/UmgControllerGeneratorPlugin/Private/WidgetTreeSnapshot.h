@@ -0,0 +1,41 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * What the code generator needs to know about a single widget.
+ */
+struct FWidgetSnapshot {
+    FString Name;
+
+    // The first native class of the widget without its prefix. Ex: "Button"
+    FString NativeClassName;
+
+    // The path to include to use the native class or an empty string if it couldn't be found
+    FString IncludePath;
+};
+
+/**
+ * A plain copy of what the code generator needs from a widget blueprint. It's built once
+ * on the game thread and doesn't reference any UObjects so it can be shared with other
+ * threads and outlive the blueprint.
+ */
+struct FWidgetTreeSnapshot {
+    // The reference path of the blueprint. Ex: "/Game/UI/WBP_Menu.WBP_Menu"
+    FString BlueprintObjectPath;
+
+    // The path the controller loads the blueprint from. Ex: "/Game/UI/WBP_Menu"
+    FString BlueprintPath;
+
+    // The name of the blueprint without the WBP_ prefix. Ex: "Menu"
+    FString WidgetName;
+
+    // Only the widgets that were given a name by the user, in widget tree order
+    TArray<FWidgetSnapshot> Widgets;
+
+    /**
+     * Returns the include path of every widget with duplicates removed. They're sorted
+     * so the order doesn't change between updates.
+     */
+    TArray<FString> GetIncludePaths() const;
+};
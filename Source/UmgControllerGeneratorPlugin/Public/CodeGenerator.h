@@ -2,11 +2,12 @@
 
 #include "CoreMinimal.h"
 #include "Components/Widget.h"
+#include "Async/Future.h"
+#include "Containers/Queue.h"
+#include "Containers/Ticker.h"
 #include "CodeGeneratorConfig.h"
 #include "CodeGenerator.generated.h"
 
-using TSection = TPair<FString, FString>;
-using TSections = TArray<TSection>;
 enum class ENotificationReason {
     Success,
     Warning,
@@ -23,35 +24,113 @@ class UCodeGenerator : public UObject {
 
 public:
     UCodeGenerator(const FObjectInitializer& initializer);
+    virtual void BeginDestroy() override;
 
-    void CreateFiles(class UWidgetBlueprint* blueprint, FString widgetPath, FString widgetName, FString widgetSuffix, const TArray<UWidget*>& widgets, FString headerPath, FString cppPath);
-    void UpdateFiles(FString widgetName, FString widgetSuffix, FString widgetPath, const TArray<UWidget*>& widgets, FString headerPath, FString cppPath);
+    /**
+     * Copies what's needed to generate a controller out of the given blueprint. The snapshot
+     * doesn't reference any UObjects so it can be used on any thread.
+     */
+    TSharedRef<const struct FWidgetTreeSnapshot, ESPMode::ThreadSafe> CreateSnapshot(class UWidgetBlueprint* blueprint);
+
+    void CreateFiles(class UWidgetBlueprint* blueprint, const TSharedRef<const struct FWidgetTreeSnapshot, ESPMode::ThreadSafe>& snapshot, FString widgetSuffix, FString headerPath, FString cppPath);
+    void UpdateFiles(const TSharedRef<const struct FWidgetTreeSnapshot, ESPMode::ThreadSafe>& snapshot, FString widgetSuffix, FString headerPath, FString cppPath);
+
+    /**
+     * Updates the controllers of all of the given blueprints with the same source map, header
+     * lookup table and settings. The blueprints are read on the game thread and the files are
+     * written on workers while a progress dialog is shown. Cancelling it skips the controllers
+     * that haven't been written yet. One notification summarizes the results when it's done.
+     *
+     * The blueprints are loaded in windows of BatchWindowSize and garbage is collected after each
+     * one so memory doesn't grow with the number of blueprints. If BatchMemoryCeilingMB is set,
+     * a window ends early when the editor goes over it and the next windows are made smaller.
+     * The packages of the next BatchPrefetchCount blueprints in the window are loaded asynchronously
+     * while the current one is read so the disk isn't idle while the game thread is busy.
+     * @param blueprintPaths The reference paths of the widget blueprints. Ex: "/Game/UI/WBP_Menu.WBP_Menu"
+     * @param verifyOnly If true, nothing is written and controllers that need an update are reported as out of date.
+     * @param outWindows If given, filled in with the memory used by each window.
+     * @return The result for each blueprint in the same order.
+     */
+    TArray<struct FControllerUpdateResult> UpdateAllFiles(const TArray<FString>& blueprintPaths, bool verifyOnly = false, TArray<struct FControllerBatchWindow>* outWindows = nullptr);
+
+    /**
+     * Returns the reference paths of the widget blueprints in the given content folder or
+     * any of its subfolders that have a controller. Ex: "/Game/UI"
+     */
+    TArray<FString> FindMappedBlueprintsIn(const FString& folderPath);
     void ShowNotification(FString message, ENotificationReason severity);
 
+    /**
+     * Builds the header lookup table and loads the blueprint source map on a worker thread
+     * so the first create or update doesn't have to. They're handed over on the game thread
+     * when they're ready. Does nothing if they're already loaded.
+     */
+    void StartWarmUp();
+
+    /**
+     * Returns the blueprint source map, loading it the first time.
+     */
+    class UBlueprintSourceMap* GetBlueprintSourceMap();
+
+    /**
+     * Keeps the source map and the widget path in each controller up to date as widget
+     * blueprints and controller files are renamed, moved or deleted.
+     */
+    void StartWatchingAssets();
+    void StopWatchingAssets();
+
     FString GetClassSuffix() { return _config->ClassSuffix; }
     FString GetBlueprintSourceDirectory() { return _config->BlueprintSourceMapDirectory; }
     FString GetBlueprintSourceFilePath();
     bool IsAutoReparentingEnabled() { return _config->EnableAutoReparenting; }
-    FString GetGeneratedMethodsPrefix() { return UnescapeNewlines(_config->GeneratedMethodsPrefix); }
-    FString GetGeneratedMethodsSuffix() { return UnescapeNewlines(_config->GeneratedMethodsSuffix); }
-    FString GetGeneratedIncludesPrefix() { return UnescapeNewlines(_config->GeneratedIncludesPrefix); }
-    FString GetGeneratedIncludesSuffix() { return UnescapeNewlines(_config->GeneratedIncludesSuffix); }
-    FString GetGeneratedLoaderPrefix() { return UnescapeNewlines(_config->GeneratedLoaderPrefix); }
-    FString GetGeneratedLoaderSuffix() { return UnescapeNewlines(_config->GeneratedLoaderSuffix); }
-    FString GetGeneratedPropertiesPrefix() { return UnescapeNewlines(_config->GeneratedPropertiesPrefix); }
-    FString GetGeneratedPropertiesSuffix() { return UnescapeNewlines(_config->GeneratedPropertiesSuffix); }
-
-private: // Fill Templates Sections
-    FString FillHeaderTemplateSections(const FString headerTemplate);
-    FString FillCppTemplateSections(const FString cppTemplate);
-    FString ReplaceSections(const FString& source, const TSections& sections);
+    const TArray<FString>& GetMappingSearchExcludedDirectories() { return _config->MappingSearchExcludedDirectories; }
+    const TArray<FString>& GetMappingSearchExtensions() { return _config->MappingSearchExtensions; }
+    bool IsBackgroundWarmUpEnabled() { return _config->EnableBackgroundWarmUp; }
+    float GetWarmUpIdleSeconds() { return _config->WarmUpIdleSeconds; }
+    int32 GetBatchWindowSize() { return _config->BatchWindowSize; }
+    int32 GetBatchMemoryCeilingMB() { return _config->BatchMemoryCeilingMB; }
+    int32 GetBatchPrefetchCount() { return _config->BatchPrefetchCount; }
+    const FString& GetGeneratedMethodsPrefix();
+    const FString& GetGeneratedMethodsSuffix();
+    const FString& GetGeneratedIncludesPrefix();
+    const FString& GetGeneratedIncludesSuffix();
+    const FString& GetGeneratedLoaderPrefix();
+    const FString& GetGeneratedLoaderSuffix();
+    const FString& GetGeneratedPropertiesPrefix();
+    const FString& GetGeneratedPropertiesSuffix();
+
+private: // Templates
+    void RefreshSections();
+    uint32 GetSectionMarkersHash() const;
+    const class FSectionSplicer& GetHeaderSections();
+    const class FSectionSplicer& GetCppSections();
+    const class FCodeTemplate& GetHeaderTemplate();
+    const class FCodeTemplate& GetCppTemplate();
+    void RefreshTemplate(TSharedPtr<const class FCodeTemplate, ESPMode::ThreadSafe>& compiledTemplate, const FString& templateFile, const FString& builtInTemplate, int32 requiredSlot);
+    FString RenderTemplate(const class FCodeTemplate& codeTemplate, const FString& widgetName, const FString& widgetSuffix, const FString& widgetPath, const FString& headerFileName);
 
 private:
-    FString UpdateHeaderFile(const TArray<UWidget*>& namedWidgets, FString headerContents, FString blueprintReferencePath);
-    FString UpdateCppFile(const TArray<UWidget*>& namedWidgets, FString cppContents);
+    struct FControllerGenerationJob PrepareJob(const TSharedRef<const struct FWidgetTreeSnapshot, ESPMode::ThreadSafe>& snapshot, FString headerPath, FString cppPath);
+    FString GetIncludePathFor(UWidget* widget);
+    void StartJob(struct FControllerGenerationJob&& job, TFunction<void(const struct FControllerGenerationResult&)> onSucceeded);
+    bool OnGenerationTick(float deltaTime);
+    bool TryClaimFiles(const struct FControllerGenerationJob& job);
+    void ReleaseFiles(const FString& headerPath, const FString& cppPath);
+    static FString GetFileKey(const FString& filePath);
+    static void ReleaseBatchPackages(const TSet<FName>& preloadedPackages, const TSet<FName>& keptPackages);
+    void ShowBatchSummary(const TArray<struct FControllerUpdateResult>& results);
+    void OnFilesCreated(TWeakObjectPtr<class UWidgetBlueprint> weakBlueprint, FString className, FString headerFilePath, FString cppFilePath);
     TArray<UWidget*> GetNamedWidgets(const TArray<UWidget*> widgets);
     UClass* GetFirstNonGeneratedParent(UClass* inputClass);
     class UHeaderLookupTable* GetHeaderLookupTable();
+    void FinishWarmUp();
+    bool UpdateWidgetPath(const FString& headerPath, const FString& widgetPath);
+    static bool WriteWidgetPath(const FString& headerPath, const FString& widgetPath);
+    void OnAssetRenamed(const struct FAssetData& asset, const FString& oldObjectPath);
+    void OnAssetRemoved(const struct FAssetData& asset);
+    void OnAssetAdded(const struct FAssetData& asset);
+    void OnSourceDirectoryChanged(const TArray<struct FFileChangeData>& fileChanges);
+    static bool IsWidgetBlueprint(const struct FAssetData& asset);
     class UBlueprint* GetBlueprintForWidget(UWidget* widget);
     void ShowSuccessMessage(FString message) { ShowNotification(message, ENotificationReason::Success); }
     void ReportWarning(FString message) { ShowNotification(message, ENotificationReason::Warning); }
@@ -62,6 +141,53 @@ private:
     UPROPERTY()
     class UHeaderLookupTable* _headerLookupTable = nullptr;
 
+    // Mapping from blueprint to the source files of its controller
+    UPROPERTY()
+    class UBlueprintSourceMap* _blueprintSourceMap = nullptr;
+
+    // What the warm-up task is loading. These are only touched by the worker
+    // until the task completes and are then moved to the members above.
+    UPROPERTY()
+    class UHeaderLookupTable* _warmUpHeaderLookupTable = nullptr;
+    UPROPERTY()
+    class UBlueprintSourceMap* _warmUpSourceMap = nullptr;
+    TFuture<void> _warmUpTask;
+
+    // Controller generation jobs running on workers. When one finishes, it queues what's
+    // left to do with its result so that runs on the game thread on the next tick.
+    TArray<TFuture<void>> _generationTasks;
+    TQueue<TFunction<void()>, EQueueMode::Mpsc> _finishedGenerations;
+    FTSTicker::FDelegateHandle _generationTickerHandle;
+
+    // Full paths of the files jobs are writing. A job for a file that's already
+    // in here is rejected rather than racing the one that's writing it.
+    TSet<FString> _filesBeingWritten;
+
+    // Header file keys to the widget path to write in them once the job writing them is done
+    TMap<FString, FString> _pendingWidgetPaths;
+
+    // The generated sections in each file with the markers from the config. They're only
+    // rebuilt when the markers change so the newlines aren't unescaped every time.
+    TSharedPtr<const class FSectionSplicer, ESPMode::ThreadSafe> _headerSections;
+    TSharedPtr<const class FSectionSplicer, ESPMode::ThreadSafe> _cppSections;
+    uint32 _sectionMarkersHash = 0;
+
+    // Asset and source watcher state so we can unregister everything when we're destroyed
+    bool _isWatchingAssets = false;
+    FDelegateHandle _assetRenamedHandle;
+    FDelegateHandle _assetRemovedHandle;
+    FDelegateHandle _assetAddedHandle;
+    FDelegateHandle _sourceWatcherHandle;
+    FString _watchedSourceDirectory;
+
+    // Full paths of mapped source files that were just deleted and when. If a file with
+    // the same name is added within a few seconds, the file was moved.
+    TArray<TPair<FString, double>> _removedSourceFiles;
+    const static inline double RemovedSourceFileLifetimeSeconds = 5.0;
+
+    // How long batch updates let queued async loads run between blueprints when there's no async loading thread
+    const static inline float PrefetchProcessingSeconds = 0.005f;
+
 	// Keeps track of the currently running creation process.
 	// This will be set to nullptr when completed.
     UPROPERTY()
@@ -75,7 +201,7 @@ private:
     UPROPERTY()
     UCodeGeneratorConfig* _config = nullptr;
 
-    // The templates for created header and cpp files
-    FString _headerFileTemplate;
-    FString _cppFileTemplate;
+    // The compiled templates for created header and cpp files
+    TSharedPtr<const class FCodeTemplate, ESPMode::ThreadSafe> _headerTemplate;
+    TSharedPtr<const class FCodeTemplate, ESPMode::ThreadSafe> _cppTemplate;
 };
@@ -17,6 +17,42 @@ public:
     UPROPERTY(Config, EditAnywhere, Category = Settings)
     bool EnableAutoReparenting = true;
 
+    UPROPERTY(Config, EditAnywhere, Category = Settings)
+    bool ShardedBlueprintSourceMap = false;
+
+    UPROPERTY(Config, EditAnywhere, Category = Settings)
+    bool TrackAssetChanges = true;
+
+    UPROPERTY(Config, EditAnywhere, Category = Settings)
+    bool LazyHeaderIndexing = true;
+
+    UPROPERTY(Config, EditAnywhere, Category = Settings)
+    bool EnableBackgroundWarmUp = false;
+
+    UPROPERTY(Config, EditAnywhere, Category = Settings, meta = (ClampMin = "0.0", EditCondition = "EnableBackgroundWarmUp"))
+    float WarmUpIdleSeconds = 5.0f;
+
+    UPROPERTY(Config, EditAnywhere, Category = "Settings|Update Mappings")
+    TArray<FString> MappingSearchExcludedDirectories = { TEXT("ThirdParty") };
+
+    UPROPERTY(Config, EditAnywhere, Category = "Settings|Update Mappings")
+    TArray<FString> MappingSearchExtensions = { TEXT(".h"), TEXT(".cpp") };
+
+    UPROPERTY(Config, EditAnywhere, Category = "Settings|Batch Updates", meta = (ClampMin = "0"))
+    int32 BatchWindowSize = 64;
+
+    UPROPERTY(Config, EditAnywhere, Category = "Settings|Batch Updates", meta = (ClampMin = "0"))
+    int32 BatchMemoryCeilingMB = 0;
+
+    UPROPERTY(Config, EditAnywhere, Category = "Settings|Batch Updates", meta = (ClampMin = "0"))
+    int32 BatchPrefetchCount = 8;
+
+    UPROPERTY(Config, EditAnywhere, Category = "Settings|Templates")
+    FString HeaderTemplateFile = TEXT("");
+
+    UPROPERTY(Config, EditAnywhere, Category = "Settings|Templates")
+    FString CppTemplateFile = TEXT("");
+
     UPROPERTY(Config, EditAnywhere, Category = "Settings|Sections")
     FString GeneratedMethodsPrefix = TEXT("// ---------- Generated Methods Section ---------- //\n//             (Don't modify manually)             //");
 
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Modules/ModuleManager.h"
+#include "Containers/Ticker.h"
 
 class FUmgControllerGeneratorPluginModule : public IModuleInterface
 {
@@ -11,4 +12,11 @@ public:
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+private:
+	void OnPostEngineInit();
+	bool OnWarmUpTick(float deltaTime);
+
+	FDelegateHandle _postEngineInitHandle;
+	FTSTicker::FDelegateHandle _warmUpTickerHandle;
 };
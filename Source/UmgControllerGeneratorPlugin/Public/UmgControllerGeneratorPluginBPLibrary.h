@@ -20,10 +20,40 @@ public:
 	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Update UMG Controller", Keywords = "UmgControllerGeneratorPlugin update umg controller"), Category = "UmgControllerGeneratorPlugin")
 	static bool UpdateUmgController(UObject* inputBlueprint);
 
+	/**
+	 * Updates the controllers of all of the given widget blueprints at once and shows
+	 * a summary when they're done.
+	 * @return Returns false if any of them could not be updated or it was cancelled.
+	 */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Update UMG Controllers", Keywords = "UmgControllerGeneratorPlugin update all umg controllers batch"), Category = "UmgControllerGeneratorPlugin")
+	static bool UpdateUmgControllers(TArray<UObject*> inputBlueprints);
+
+	/**
+	 * Updates the controller of every widget blueprint in the given content folder or any
+	 * of its subfolders that has one. Ex: "/Game/UI"
+	 * @return Returns false if any of them could not be updated or it was cancelled.
+	 */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Update UMG Controllers In Folder", Keywords = "UmgControllerGeneratorPlugin update all umg controllers folder"), Category = "UmgControllerGeneratorPlugin")
+	static bool UpdateUmgControllersInFolder(FString folderPath);
+
 	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Update Mappings ", Keywords = "UmgControllerGeneratorPlugin update mappings"), Category = "UmgControllerGeneratorPlugin")
 	static bool UpdateMappings(TArray<UObject*> inputBlueprints);
 
-private:
+	/**
+	 * Returns the reference path of the widget blueprint whose controller is in the given
+	 * header or cpp file, or an empty string if no blueprint is mapped to it.
+	 * The path can be absolute or relative to the project directory.
+	 */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Find Blueprint For Source File", Keywords = "UmgControllerGeneratorPlugin find blueprint source file"), Category = "UmgControllerGeneratorPlugin")
+	static FString FindBlueprintForSourceFile(FString sourcePath);
+
+	/**
+	 * Returns the code generator shared by every call, creating it the first time.
+	 */
 	static class UCodeGenerator* GetCodeGenerator();
+
+private:
+	static bool UpdateControllersAt(const TArray<FString>& blueprintPaths);
+
 	static inline class UCodeGenerator* _codeGeneratorInstance = nullptr;
 };
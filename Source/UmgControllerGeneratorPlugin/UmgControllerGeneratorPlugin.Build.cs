@@ -47,6 +47,10 @@ public class UmgControllerGeneratorPlugin : ModuleRules
 				"BlueprintEditorLibrary",
 				"UnrealEd",
 				"EditorStyle",
+				"DirectoryWatcher",
+				"AssetRegistry",
+				"Projects",
+				"Settings",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);